@@ -0,0 +1,211 @@
+/**
+ * @file nodice/animation.cpp
+ * @brief Implemntation of the nodice/animation module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/animation.h"
+
+
+namespace
+{
+  static const int x_spin_speed = 1;
+  static const int y_spin_speed = 6;
+  static const int fade_ticks = 20;
+  static const int fall_ticks = 10;
+
+  /** The moves_left_ of a die drifting until it is told to stop. */
+  static const int drifting = -1;
+
+  /**
+   * Moves every die on by one tick.  A die spins only while it is not fading.
+   *
+   * Everything is done with arithmetic on 0/1 flags rather than branches so
+   * the loop vectorizes.  The arrays are passed as restricted parameters so
+   * the compiler knows they do not overlap; otherwise it would need more
+   * run-time overlap checks than it is willing to make.
+   */
+  void
+  tick(std::size_t const n,
+       float* __restrict__ x, float* __restrict__ y, float* __restrict__ z,
+       float* __restrict__ vx, float* __restrict__ vy, float* __restrict__ vz,
+       std::int32_t* __restrict__ moves_left,
+       std::int32_t* __restrict__ fade_left,
+       std::int32_t* __restrict__ is_fading,
+       std::int32_t* __restrict__ x_angle,
+       std::int32_t* __restrict__ y_angle)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      std::int32_t const fading = is_fading[i] & (fade_left[i] > 0);
+      fade_left[i] -= fading;
+      is_fading[i] = fading;
+
+      std::int32_t const spinning = 1 - fading;
+      std::int32_t const xa = x_angle[i] + spinning * x_spin_speed;
+      std::int32_t const ya = y_angle[i] + spinning * y_spin_speed;
+      x_angle[i] = xa - 360 * (xa >= 360);
+      y_angle[i] = ya - 360 * (ya >= 360);
+
+      x[i] += vx[i];
+      y[i] += vy[i];
+      z[i] += vz[i];
+
+      std::int32_t const left = moves_left[i] - (moves_left[i] > 0);
+      std::int32_t const moving = left != 0;
+      float const keep = float(moving);
+      moves_left[i] = left;
+      vx[i] *= keep;
+      vy[i] *= keep;
+      vz[i] *= keep;
+    }
+  }
+
+  /** Turns every position and velocity a quarter turn clockwise. */
+  void
+  turn(std::size_t const n, float const extent,
+       float* __restrict__ x, float* __restrict__ y,
+       float* __restrict__ vx, float* __restrict__ vy)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      float const old_x = x[i];
+      x[i] = y[i];
+      y[i] = extent - old_x;
+
+      float const old_vx = vx[i];
+      vx[i] = vy[i];
+      vy[i] = -old_vx;
+    }
+  }
+} // anonymous namespace
+
+
+NoDice::Animation::
+Animation(std::size_t slot_count)
+: x_(slot_count, 0.0f), y_(slot_count, 0.0f), z_(slot_count, 0.0f)
+, vx_(slot_count, 0.0f), vy_(slot_count, 0.0f), vz_(slot_count, 0.0f)
+, moves_left_(slot_count, 0)
+, fade_left_(slot_count, fade_ticks)
+, is_fading_(slot_count, 0)
+, x_angle_(slot_count, 0)
+, y_angle_(slot_count, 0)
+{ }
+
+
+std::size_t NoDice::Animation::
+size() const
+{ return x_.size(); }
+
+
+void NoDice::Animation::
+start(Slot slot, Vector3f const& position, int x_angle, int y_angle)
+{
+  x_[slot] = position.x;
+  y_[slot] = position.y;
+  z_[slot] = position.z;
+  stop(slot);
+  fade_left_[slot] = fade_ticks;
+  is_fading_[slot] = 0;
+  x_angle_[slot] = x_angle;
+  y_angle_[slot] = y_angle;
+}
+
+
+NoDice::Vector3f NoDice::Animation::
+position(Slot slot) const
+{ return Vector3f(x_[slot], y_[slot], z_[slot]); }
+
+
+int NoDice::Animation::
+x_angle(Slot slot) const
+{ return x_angle_[slot]; }
+
+
+int NoDice::Animation::
+y_angle(Slot slot) const
+{ return y_angle_[slot]; }
+
+
+float NoDice::Animation::
+fade(Slot slot) const
+{ return float(fade_left_[slot]) / fade_ticks; }
+
+
+void NoDice::Animation::
+set_velocity(Slot slot, Vector3f const& velocity)
+{
+  vx_[slot] = velocity.x;
+  vy_[slot] = velocity.y;
+  vz_[slot] = velocity.z;
+  moves_left_[slot] = drifting;
+}
+
+
+void NoDice::Animation::
+stop(Slot slot)
+{
+  vx_[slot] = vy_[slot] = vz_[slot] = 0.0f;
+  moves_left_[slot] = 0;
+}
+
+
+/**
+ * A falling die covers the distance in equal steps over a fixed number of
+ * ticks and then stops dead.
+ */
+void NoDice::Animation::
+start_falling(Slot slot, Vector3f const& target)
+{
+  set_velocity(slot, (target - position(slot)) / float(fall_ticks));
+  moves_left_[slot] = fall_ticks;
+}
+
+
+bool NoDice::Animation::
+is_falling(Slot slot) const
+{ return moves_left_[slot] > 0; }
+
+
+void NoDice::Animation::
+start_disappearing(Slot slot)
+{ is_fading_[slot] = 1; }
+
+
+bool NoDice::Animation::
+has_disappeared(Slot slot) const
+{ return fade_left_[slot] <= 0; }
+
+
+void NoDice::Animation::
+update()
+{
+  tick(size(),
+       x_.data(), y_.data(), z_.data(),
+       vx_.data(), vy_.data(), vz_.data(),
+       moves_left_.data(), fade_left_.data(), is_fading_.data(),
+       x_angle_.data(), y_angle_.data());
+}
+
+
+void NoDice::Animation::
+turn_clockwise(float extent)
+{
+  turn(size(), extent, x_.data(), y_.data(), vx_.data(), vy_.data());
+}
@@ -0,0 +1,132 @@
+/**
+ * @file nodice/animation.h
+ * @brief Public interface of the nodice/animation module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_ANIMATION_H
+#define NODICE_ANIMATION_H 1
+
+#include <cstdint>
+#include "nodice/maths.h"
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * The moving parts of a board full of dice: where each one is, where it is
+   * going, how far it has faded and how far it has spun.
+   *
+   * Each quantity is kept in its own array with one slot per die, so a tick
+   * is a single branch-free pass down the arrays that the compiler can turn
+   * into SIMD code.  Falling and fading are counted in whole ticks, so the
+   * loop only ever compares integers: with the default trapping floating
+   * point, GCC will not vectorize a loop that compares floats.
+   *
+   * Slots are numbered the same way as the board's object pool.
+   */
+  class Animation
+  {
+  public:
+    typedef std::uint32_t Slot;
+
+  public:
+    /** Constructs the animation state for @p slot_count dice, all at rest. */
+    explicit
+    Animation(std::size_t slot_count);
+
+    /** Gets the number of slots. */
+    std::size_t
+    size() const;
+
+    /**
+     * Puts a die at rest in a slot, fully visible.
+     * @param[in] slot     the slot to use
+     * @param[in] position where the die is
+     * @param[in] x_angle  how far the die has spun about the x axis, in degrees
+     * @param[in] y_angle  how far the die has spun about the y axis, in degrees
+     */
+    void
+    start(Slot slot, Vector3f const& position, int x_angle, int y_angle);
+
+    /** Gets where a die is. */
+    Vector3f
+    position(Slot slot) const;
+
+    /** Gets how far a die has spun about the x axis, in degrees. */
+    int
+    x_angle(Slot slot) const;
+
+    /** Gets how far a die has spun about the y axis, in degrees. */
+    int
+    y_angle(Slot slot) const;
+
+    /** Gets how visible a die is, from 1 (fully) down to 0 (gone). */
+    float
+    fade(Slot slot) const;
+
+    /** Sets a die drifting at a fixed velocity until it is stopped. */
+    void
+    set_velocity(Slot slot, Vector3f const& velocity);
+
+    /** Stops a die drifting. */
+    void
+    stop(Slot slot);
+
+    /** Starts a die falling to a new position. */
+    void
+    start_falling(Slot slot, Vector3f const& target);
+
+    /** Indicates if a die is still falling. */
+    bool
+    is_falling(Slot slot) const;
+
+    /** Starts a die fading away. */
+    void
+    start_disappearing(Slot slot);
+
+    /** Indicates if a die has faded away completely. */
+    bool
+    has_disappeared(Slot slot) const;
+
+    /** Moves every die on by one tick. */
+    void
+    update();
+
+    /**
+     * Moves every die a quarter turn clockwise about the middle of a board
+     * laid out from (0, 0) to (extent, extent), to go with Grid::rotate().
+     */
+    void
+    turn_clockwise(float extent);
+
+  private:
+    std::vector<float>        x_, y_, z_;
+    std::vector<float>        vx_, vy_, vz_;
+    std::vector<std::int32_t> moves_left_;
+    std::vector<std::int32_t> fade_left_;
+    std::vector<std::int32_t> is_fading_;
+    std::vector<std::int32_t> x_angle_, y_angle_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_ANIMATION_H
@@ -24,9 +24,9 @@
 
 #include <cassert>
 #include <cstdlib>
-#include <ctime>
 #include <iostream>
 #include "nodice/config.h"
+#include "nodice/glstate.h"
 #include "nodice/introstate.h"
 #include "nodice/video.h"
 #include <SDL.h>
@@ -71,7 +71,8 @@ App(NoDice::Config* config)
 , font_cache_(config)
 , game_is_running_(false)
 {
-  std::srand(std::time(NULL));
+  if (config_->is_debug_mode())
+    std::cerr << "==smw> random seed " << config_->seed() << "\n";
   push_game_state(GameStatePtr(new IntroState(this, video_)));
 }
 
@@ -79,6 +80,9 @@ App(NoDice::Config* config)
 NoDice::App::
 ~App()
 {
+  if (config_->is_debug_mode())
+    std::cerr << "==smw> GL state changes made " << glState().change_count()
+              << ", skipped " << glState().avoided_count() << "\n";
 }
 
 int NoDice::App::
@@ -0,0 +1,282 @@
+/**
+ * @file nodice/bitboard.cpp
+ * @brief Implemntation of the nodice/bitboard module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/bitboard.h"
+
+#include <algorithm>
+
+
+namespace
+{
+  typedef std::uint64_t Word;
+
+  static const int bits_per_word = NoDice::BitBoard::columns_per_word;
+
+  inline bool
+  test_bit(Word const* words, int bit)
+  {
+    return (words[bit / bits_per_word] >> (bit % bits_per_word)) & 1u;
+  }
+
+  /**
+   * Finds the first bit at or after @p bit that is set (or clear, if @p invert
+   * is true), or returns @p limit if there is none.
+   */
+  int
+  scan_bits(Word const* words, int bit, int limit, bool invert)
+  {
+    while (bit < limit)
+    {
+      Word w = words[bit / bits_per_word];
+      if (invert)
+        w = ~w;
+      w >>= (bit % bits_per_word);
+      if (w)
+        return std::min(bit + __builtin_ctzll(w), limit);
+      bit = (bit / bits_per_word + 1) * bits_per_word;
+    }
+    return limit;
+  }
+} // anonymous namespace
+
+
+NoDice::BitBoard::
+BitBoard(int size, int plane_count)
+: size_(size)
+, plane_count_(plane_count)
+, words_per_row_((size + bits_per_word - 1) / bits_per_word)
+, bits_(plane_count * size * words_per_row_, 0)
+, dirty_(size * words_per_row_, 0)
+{
+  mark_all_dirty();
+}
+
+
+int NoDice::BitBoard::
+size() const
+{ return size_; }
+
+
+int NoDice::BitBoard::
+plane_count() const
+{ return plane_count_; }
+
+
+NoDice::BitBoard::Word* NoDice::BitBoard::
+row(int plane, int y)
+{ return &bits_[(plane * size_ + y) * words_per_row_]; }
+
+
+NoDice::BitBoard::Word const* NoDice::BitBoard::
+row(int plane, int y) const
+{ return &bits_[(plane * size_ + y) * words_per_row_]; }
+
+
+int NoDice::BitBoard::
+plane_at(int x, int y) const
+{
+  for (int k = 0; k < plane_count_; ++k)
+  {
+    if (test_bit(row(k, y), x))
+      return k;
+  }
+  return -1;
+}
+
+
+void NoDice::BitBoard::
+set(int x, int y, int plane)
+{
+  clear(x, y);
+  if (plane >= 0)
+  {
+    row(plane, y)[x / bits_per_word] |= Word(1) << (x % bits_per_word);
+  }
+}
+
+
+void NoDice::BitBoard::
+clear(int x, int y)
+{
+  Word const mask = ~(Word(1) << (x % bits_per_word));
+  for (int k = 0; k < plane_count_; ++k)
+  {
+    row(k, y)[x / bits_per_word] &= mask;
+  }
+  mark_dirty(x, y);
+}
+
+
+void NoDice::BitBoard::
+mark_dirty(int x, int y)
+{
+  dirty_[y * words_per_row_ + x / bits_per_word] |= Word(1) << (x % bits_per_word);
+}
+
+
+void NoDice::BitBoard::
+mark_all_dirty()
+{
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+      mark_dirty(x, y);
+  }
+}
+
+
+void NoDice::BitBoard::
+swap(int x1, int y1, int x2, int y2)
+{
+  int const p1 = plane_at(x1, y1);
+  int const p2 = plane_at(x2, y2);
+  set(x1, y1, p2);
+  set(x2, y2, p1);
+}
+
+
+void NoDice::BitBoard::
+find_runs(RunList& runs) const
+{
+  scan_runs(runs, false);
+}
+
+
+void NoDice::BitBoard::
+find_dirty_runs(RunList& runs)
+{
+  scan_runs(runs, true);
+  std::fill(dirty_.begin(), dirty_.end(), 0);
+}
+
+
+/**
+ * A run of 3 starting at bit x is (row & row>>1 & row>>2) at x.  Two adjacent
+ * starts can only ever come from the same plane, so the starts for all planes
+ * are ORed together and a run of length n shows up as n-2 consecutive starts.
+ *
+ * Columns are done the same way by ANDing three consecutive rows, which gives
+ * the start of every vertical run of 3 in a row's worth of columns at once.
+ *
+ * When only dirty cells are of interest, the rows without a dirty cell are
+ * skipped, the column starts are only worked out for words holding a dirty
+ * column, and runs that miss every dirty cell are dropped.
+ */
+void NoDice::BitBoard::
+scan_runs(RunList& runs, bool only_dirty) const
+{
+  runs.clear();
+  if (size_ < 3)
+    return;
+
+  int const start_rows = size_ - 2;
+  scratch_.assign((start_rows + 2) * words_per_row_, 0);
+  Word* const hstarts = &scratch_[start_rows * words_per_row_];
+  Word* const columns = hstarts + words_per_row_;
+
+  // check for 3-or-more-in-a-row
+  for (int y = 0; y < size_; ++y)
+  {
+    Word const* dirty = &dirty_[y * words_per_row_];
+    if (only_dirty)
+    {
+      bool is_dirty = false;
+      for (int w = 0; w < words_per_row_; ++w)
+      {
+        columns[w] |= dirty[w];
+        is_dirty = is_dirty || dirty[w];
+      }
+      if (!is_dirty)
+        continue;
+    }
+
+    std::fill(hstarts, hstarts + words_per_row_, 0);
+    for (int k = 0; k < plane_count_; ++k)
+    {
+      Word const* r = row(k, y);
+      for (int w = 0; w < words_per_row_; ++w)
+      {
+        Word const next = (w + 1 < words_per_row_) ? r[w+1] : 0;
+        Word const s1 = (r[w] >> 1) | (next << (bits_per_word - 1));
+        Word const s2 = (r[w] >> 2) | (next << (bits_per_word - 2));
+        hstarts[w] |= r[w] & s1 & s2;
+      }
+    }
+
+    int x = scan_bits(hstarts, 0, size_, false);
+    while (x < size_)
+    {
+      int const end = scan_bits(hstarts, x, size_, true);
+      if (!only_dirty || scan_bits(dirty, x, end + 2, false) < end + 2)
+        runs.push_back(Run{ x, y, 1, 0, end - x + 2 });
+      x = scan_bits(hstarts, end, size_, false);
+    }
+  }
+
+  // check for 3-in-a-column
+  if (!only_dirty)
+    std::fill(columns, columns + words_per_row_, ~Word(0));
+  for (int y = 0; y < start_rows; ++y)
+  {
+    Word* vstarts = &scratch_[y * words_per_row_];
+    for (int w = 0; w < words_per_row_; ++w)
+    {
+      if (!columns[w])
+        continue;
+      for (int k = 0; k < plane_count_; ++k)
+      {
+        vstarts[w] |= row(k, y)[w] & row(k, y+1)[w] & row(k, y+2)[w];
+      }
+      vstarts[w] &= columns[w];
+    }
+  }
+
+  RunList::size_type const first_vertical = runs.size();
+  for (int y = 0; y < start_rows; ++y)
+  {
+    Word const* vstarts = &scratch_[y * words_per_row_];
+    for (int w = 0; w < words_per_row_; ++w)
+    {
+      Word fresh = vstarts[w];
+      if (y > 0)
+        fresh &= ~vstarts[w - words_per_row_];
+      while (fresh)
+      {
+        int const x = w * bits_per_word + __builtin_ctzll(fresh);
+        fresh &= fresh - 1;
+        int end = y + 1;
+        while (end < start_rows && test_bit(&scratch_[end * words_per_row_], x))
+          ++end;
+        bool is_dirty = !only_dirty;
+        for (int i = y; !is_dirty && i < end + 2; ++i)
+          is_dirty = test_bit(&dirty_[i * words_per_row_], x);
+        if (is_dirty)
+          runs.push_back(Run{ x, y, 0, 1, end - y + 2 });
+      }
+    }
+  }
+  std::sort(runs.begin() + first_vertical, runs.end(),
+            [](Run const& lhs, Run const& rhs)
+            {
+              return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+            });
+}
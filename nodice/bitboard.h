@@ -0,0 +1,146 @@
+/**
+ * @file nodice/bitboard.h
+ * @brief Public interface of the nodice/bitboard module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_BITBOARD_H
+#define NODICE_BITBOARD_H 1
+
+#include <cstdint>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * A square board stored as one bit-plane per kind of cell.
+   *
+   * Bit x of row y in plane k is set when cell (x, y) holds something of kind
+   * k.  At most one plane has a given cell set; an empty cell has no bit set in
+   * any plane.  Rows are packed into 64-bit words so runs can be found with
+   * shift-and-AND over whole rows and columns at once.
+   *
+   * Every cell that changes is also marked dirty so that, as long as the board
+   * had no runs the last time it was checked, the new runs can be found by
+   * looking only at the rows and columns through the dirty cells.
+   */
+  class BitBoard
+  {
+  public:
+    /** A straight line of 3 or more cells of the same kind. */
+    struct Run
+    {
+      int x, y;     ///< the first (lowest or leftmost) cell in the run
+      int dx, dy;   ///< the step from one cell in the run to the next
+      int length;   ///< the number of cells in the run
+    };
+
+    typedef std::vector<Run> RunList;
+
+    /**
+     * The number of columns packed into each word of a row.  Columns in
+     * different words can be changed from different threads at once; columns
+     * sharing a word can not.
+     */
+    static const int columns_per_word = 64;
+
+  public:
+    /**
+     * Constructs an empty board.
+     * @param[in] size        the number of cells along each side
+     * @param[in] plane_count the number of different kinds of cell
+     */
+    BitBoard(int size, int plane_count);
+
+    /** Gets the number of cells along each side of the board. */
+    int
+    size() const;
+
+    /** Gets the number of planes (kinds of cell). */
+    int
+    plane_count() const;
+
+    /** Gets the plane of the cell at (x, y), or -1 if the cell is empty. */
+    int
+    plane_at(int x, int y) const;
+
+    /** Puts a cell of kind @p plane at (x, y), or empties it if @p plane < 0. */
+    void
+    set(int x, int y, int plane);
+
+    /** Empties the cell at (x, y). */
+    void
+    clear(int x, int y);
+
+    /** Exchanges the contents of two cells. */
+    void
+    swap(int x1, int y1, int x2, int y2);
+
+    /**
+     * Finds all the maximal runs of 3 or more.
+     * @param[out] runs  receives the horizontal runs in row order followed by
+     *                   the vertical runs in column order
+     */
+    void
+    find_runs(RunList& runs) const;
+
+    /**
+     * Finds the maximal runs of 3 or more that pass through a cell changed
+     * since the last call, and marks the whole board clean.
+     * @param[out] runs  receives the runs in the same order as find_runs()
+     *
+     * If the board had no runs when it was last marked clean this gives exactly
+     * the same result as find_runs().  A new board starts out all dirty.
+     */
+    void
+    find_dirty_runs(RunList& runs);
+
+    /** Marks every cell as changed. */
+    void
+    mark_all_dirty();
+
+  private:
+    typedef std::uint64_t Word;
+
+    void
+    mark_dirty(int x, int y);
+
+    void
+    scan_runs(RunList& runs, bool only_dirty) const;
+
+    Word*
+    row(int plane, int y);
+
+    Word const*
+    row(int plane, int y) const;
+
+  private:
+    int               size_;
+    int               plane_count_;
+    int               words_per_row_;
+    std::vector<Word> bits_;
+    std::vector<Word> dirty_;
+    mutable std::vector<Word> scratch_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_BITBOARD_H
@@ -19,54 +19,112 @@
  */
 #include "nodice/board.h"
 
+#include <algorithm>
 #include <iostream>
 #include "nodice/config.h"
 #include "nodice/object.h"
+#include "nodice/rotate.h"
+#include "nodice/shape.h"
 
 namespace
 {
   static const float swap_factor = 10.0f;
   static const float swap_step = 0.5f;
+
+  /** How far the board swings round each tick while rotating, in degrees. */
+  static const float rotate_step = 4.5f;
+
+  /** Boards at least this big collapse and refill on more than one thread. */
+  static const int parallel_board_size = 128;
 } // anonymous namespace
 
 
+/**
+ * The objects' spin is only for show, so it comes from a separate stream that
+ * leaves the game's own stream the same with or without the pretty pictures.
+ */
 NoDice::Board::
 Board(NoDice::Config const* config)
 : config_(config)
+, grid_(config_->board_size(), NoDice::shapeRegistry().size(), config_->seed())
+, objects_(config_->board_size() * config_->board_size())
+, handles_(config_->board_size() * config_->board_size(), ObjectPool::no_handle)
+, animation_(objects_.capacity())
+, spin_random_(~config_->seed())
+, matcher_(config_->board_size())
 , state_(state_idle)
+, is_move_pending_(false)
+, rotation_(0.0f)
 {
+  if (config_->board_size() >= parallel_board_size)
+  {
+    pool_.reset(new ThreadPool);
+    grid_.set_thread_pool(pool_.get());
+  }
+  grid_.generate();
   for (int y = 0; y < config_->board_size(); ++y)
   {
     for (int x = 0; x < config_->board_size(); ++x)
     {
-      objects_.push_back(ObjectPtr(new Object(NoDice::chooseAShape(),
-                                     Vector3f(x * 2.0f, y * 2.0f, 0.0f))));
+      create_object(Vector2i(x, y));
     }
   }
-  if (find_wins().size() > 0)
-  {
-    state_ = state_removing;
-  }
 }
 
 
-NoDice::ObjectPtr&  NoDice::Board::
-at(const NoDice::Vector2i& p)
-{ return objects_[p.x + p.y * config_->board_size()]; }
+NoDice::ObjectHandle& NoDice::Board::
+handle_at(const NoDice::Vector2i& p)
+{ return handles_[p.x + p.y * config_->board_size()]; }
+
+
+NoDice::ObjectHandle NoDice::Board::
+handle_at(const NoDice::Vector2i& p) const
+{ return handles_[p.x + p.y * config_->board_size()]; }
+
 
+NoDice::Object& NoDice::Board::
+at(int x, int y)
+{ return objects_[handles_[x + y * config_->board_size()]]; }
 
-const NoDice::ObjectPtr&  NoDice::Board::
+
+const NoDice::Object& NoDice::Board::
 at(int x, int y) const
-{ return objects_[x + y * config_->board_size()]; }
+{ return objects_[handles_[x + y * config_->board_size()]]; }
+
+
+NoDice::Grid const& NoDice::Board::
+grid() const
+{ return grid_; }
+
+
+NoDice::Random& NoDice::Board::
+random()
+{ return grid_.random(); }
+
+
+/**
+ * Creates the object to show the shape in a grid cell, recycling the slot of
+ * whatever object was left there.  The object's animation lives in the slot
+ * with the same number, and starts spinning from a random angle.
+ */
+void NoDice::Board::
+create_object(const NoDice::Vector2i& p)
+{
+  ObjectHandle& handle = handle_at(p);
+  if (handle != ObjectPool::no_handle)
+    objects_.destroy(handle);
+  handle = objects_.create(grid_.at(p.x, p.y));
+  animation_.start(handle,
+                   Vector3f(p.x * 2.0f, p.y * 2.0f, 0.0f),
+                   float(spin_random_.below(180)),
+                   float(spin_random_.below(90)));
+}
 
 
 void NoDice::Board::
 update()
 {
-  for (auto it = objects_.begin(); it != objects_.end(); ++it)
-  {
-    (*it)->update();
-  }
+  animation_.update();
 
   switch (state_)
   {
@@ -75,11 +133,10 @@ update()
       swap_step_ += swap_step;
       if (swap_step_ > swap_factor)
       {
-        at(swap_obj_[0]).swap(at(swap_obj_[1]));
-        for (auto it = objects_.begin(); it != objects_.end(); ++it)
-        {
-          (*it)->setVelocity(Vector3f(0.0f, 0.0f, 0.0f));
-        }
+        std::swap(handle_at(swap_obj_[0]), handle_at(swap_obj_[1]));
+        grid_.swap(swap_obj_[0], swap_obj_[1]);
+        animation_.stop(handle_at(swap_obj_[0]));
+        animation_.stop(handle_at(swap_obj_[1]));
         state_ = state_idle;
       }
       break;
@@ -90,32 +147,16 @@ update()
       // Wait until all disappearing is finished.
       for (auto it = removal_queue_.begin(); it != removal_queue_.end(); ++it)
       {
-        if (!at(*it)->hasDisappeared())
+        if (!animation_.has_disappeared(handle_at(*it)))
           return;
       }
 
       state_ = state_falling;
-      for (int x = 0; x < config_->board_size(); ++x)
+      grid_.collapse(falling_queue_, create_queue_);
+      for (auto it = falling_queue_.begin(); it != falling_queue_.end(); ++it)
       {
-        int drop = 0;
-        for (int y = 0; y < config_->board_size(); ++y)
-        {
-          if (at(x, y)->hasDisappeared())
-          {
-            ++drop;
-          }
-          else if (drop > 0)
-          {
-            at(x, y)->startFalling(Vector3f(2.0f * x, 2.0f * (y - drop), 0.0f));
-            falling_queue_.push_back(std::make_pair(Vector2i(x, y),
-                                                    Vector2i(x, y - drop)));
-          }
-        }
-        for (int y = 0; y < drop; ++y)
-        {
-          int new_y = config_->board_size() - y - 1;
-          create_queue_.push_back(Vector2i(x, new_y));
-        }
+        animation_.start_falling(handle_at(Vector2i(it->x, it->from_y)),
+                                 Vector3f(2.0f * it->x, 2.0f * it->to_y, 0.0f));
       }
       removal_queue_.clear();
       break;
@@ -126,23 +167,28 @@ update()
       // Wait until all falling is finished.
       for (auto it = falling_queue_.begin(); it != falling_queue_.end(); ++it)
       {
-        if (at((*it).first)->isFalling())
+        if (animation_.is_falling(handle_at(Vector2i(it->x, it->from_y))))
           return;
       }
 
       // Percolate removed jobbies out
       for (auto it = falling_queue_.begin(); it != falling_queue_.end(); ++it)
       {
-        at((*it).first).swap(at((*it).second));
-        ObjectPtr().swap(at((*it).first));
+        ObjectHandle& from = handle_at(Vector2i(it->x, it->from_y));
+        ObjectHandle& to = handle_at(Vector2i(it->x, it->to_y));
+        if (to != ObjectPool::no_handle)
+          objects_.destroy(to);
+        to = from;
+        from = ObjectPool::no_handle;
       }
       falling_queue_.clear();
 
       // Fill in the blanks.
+      grid_.refill(create_queue_);
+      history_.add_refills(grid_, create_queue_);
       for (auto it = create_queue_.begin(); it != create_queue_.end(); ++it)
       {
-        at(*it) = ObjectPtr(new Object(NoDice::chooseAShape(),
-                            Vector3f((*it).x * 2.0f, (*it).y * 2.0f, 0.0f)));
+        create_object(*it);
       }
       create_queue_.clear();
 
@@ -150,6 +196,14 @@ update()
       break;
     }
 
+    case state_rotating:
+    {
+      rotation_ = std::max(rotation_ - rotate_step, 0.0f);
+      if (rotation_ == 0.0f)
+        state_ = state_idle;
+      break;
+    }
+
     default:
       break;
   }
@@ -161,13 +215,27 @@ draw() const
 {
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
+  if (rotation_ != 0.0f)
+  {
+    float const middle = float(config_->board_size() - 1);
+    glTranslatef(middle, middle, 0.0f);
+    glRotatef(rotation_, 0.0f, 0.0f, 1.0f);
+    glTranslatef(-middle, -middle, 0.0f);
+  }
+  batch_.clear();
   for (int y = 0; y < config_->board_size(); ++y)
   {
     for (int x = 0; x < config_->board_size(); ++x)
     {
-      at(x, y)->draw();
+      ObjectHandle const handle = handle_at(Vector2i(x, y));
+      objects_[handle].draw(batch_,
+                            animation_.position(handle),
+                            animation_.x_angle(handle),
+                            animation_.y_angle(handle),
+                            animation_.fade(handle));
     }
   }
+  batch_.draw();
   glPopMatrix();
 }
 
@@ -177,16 +245,17 @@ start_swap(NoDice::Vector2i pos1, NoDice::Vector2i pos2)
 {
   swap_obj_[0] = pos1;
   swap_obj_[1] = pos2;
-  ObjectPtr obj1 = at(pos1.x, pos1.y);
-  ObjectPtr obj2 = at(pos2.x, pos2.y);
-  obj1->setVelocity(Vector3f(float(pos2.x-pos1.x) / swap_factor,
-                             float(pos2.y-pos1.y) / swap_factor,
-                             0.0f));
-  obj2->setVelocity(Vector3f(float(pos1.x-pos2.x) / swap_factor,
-                             float(pos1.y-pos2.y) / swap_factor,
-                             0.0f));
+  animation_.set_velocity(handle_at(pos1),
+                          Vector3f(float(pos2.x-pos1.x) / swap_factor,
+                                   float(pos2.y-pos1.y) / swap_factor,
+                                   0.0f));
+  animation_.set_velocity(handle_at(pos2),
+                          Vector3f(float(pos1.x-pos2.x) / swap_factor,
+                                   float(pos1.y-pos2.y) / swap_factor,
+                                   0.0f));
   swap_step_ = 0.0f;
   state_ = state_swapping;
+  is_move_pending_ = true;
 }
 
 
@@ -211,94 +280,165 @@ is_replacing() const
 }
 
 
+/**
+ * The grid and the cell handles are turned the same way, and the dice are
+ * moved to their new places in one pass over the animation arrays, so no
+ * object is touched.  The board is then drawn turned back a quarter turn
+ * anticlockwise, which looks just as it did, and swings round from there;
+ * that costs one extra matrix per frame however big the board is.
+ */
+void NoDice::Board::
+start_rotating()
+{
+  int const size = config_->board_size();
+  history_.begin_rearrange(grid_);
+  grid_.rotate();
+  history_.end_rearrange(grid_);
+  std::vector<ObjectHandle> turned(handles_.size());
+  rotate_clockwise(handles_.data(), turned.data(), size);
+  handles_.swap(turned);
+  animation_.turn_clockwise(2.0f * (size - 1));
+  rotation_ = 90.0f;
+  state_ = state_rotating;
+}
+
+
+bool NoDice::Board::
+is_rotating() const
+{
+  return state_ == state_rotating;
+}
+
+
 /**
  * Looks for 3 (or more) matching objects in a row, horizontal or vertical.
+ *
+ * The runs come from the grid's bitboard, horizontal runs first in row order
+ * and then vertical runs in column order, which is the order a cell-by-cell
+ * scan would find them.
+ *
+ * Only runs through cells that have changed since the last call are looked
+ * for: the swapped cells, and the cells that were cleared, fell, or were
+ * refilled.  The board never settles with a run on it, so any run must pass
+ * through one of those and the result is the same as a full scan.
+ *
+ * The matched cells are emptied in the grid straight away; their objects hang
+ * around until they have finished disappearing.
  */
-NoDice::ObjectBrace NoDice::Board::
+const NoDice::ObjectBrace& NoDice::Board::
 find_wins()
 {
-  ObjectBrace matches;
-
-  // check for 3-or-more-in-a-row
-  for (int y = 0; y < config_->board_size(); ++y)
+  grid_.find_matches(runs_);
+  matcher_.group(grid_, runs_, groups_);
+  if (!groups_.empty())
   {
-    int x = 0;
-    while (x <  config_->board_size()-2)
-    {
-      int count = 0;
-      const ObjectPtr& obj = at(x, y);
-      auto type = obj->type();
-      for (int i = x; i < config_->board_size(); ++i)
-      {
-        if (type == at(i, y)->type())
-        {
-          ++count;
-        }
-        else
-          break;
-      }
-      if (count > 2)
-      {
-        ObjectBag brace;
-        for (int i = 0; i < count; ++i)
-        {
-          const Vector2i p(x+i, y);
-          removal_queue_.push_back(p);
-          ObjectPtr& o = at(p);
-          brace.push_back(o);
-          o->startDisappearing();
-        }
-        matches.push_back(brace);
-        x += count;
-      }
-      else
-      {
-        ++x;
-      }
-    }
+    if (is_move_pending_)
+      history_.begin_move(grid_, Grid::Move(swap_obj_[0], swap_obj_[1]));
+    history_.add_removed(grid_, groups_);
   }
-
-  // check for 3-in-a-column
-  for (int x = 0; x < config_->board_size(); ++x)
+  is_move_pending_ = false;
+  matches_.resize(groups_.size());
+  for (MatchGroupList::size_type g = 0; g < groups_.size(); ++g)
   {
-    int y = 0;
-    while (y <  config_->board_size()-2)
+    ObjectBag& brace = matches_[g];
+    brace.clear();
+    for (auto const& p: groups_[g].cells)
     {
-      int count = 0;
-      const ObjectPtr& obj = at(x, y);
-      auto type = obj->type();
-      for (int i = y; i < config_->board_size(); ++i)
-      {
-        if (type == at(x, i)->type())
-        {
-          ++count;
-        }
-        else
-          break;
-      }
-      if (count > 2)
-      {
-        ObjectBag brace;
-        for (int i = 0; i < count; ++i)
-        {
-          const Vector2i p(x, y+i);
-          removal_queue_.push_back(p);
-          ObjectPtr& o = at(p);
-          brace.push_back(o);
-          o->startDisappearing();
-        }
-        matches.push_back(brace);
-        y += count;
-      }
-      else
-      {
-        ++y;
-      }
+      removal_queue_.push_back(p);
+      brace.push_back(&at(p.x, p.y));
+      animation_.start_disappearing(handle_at(p));
     }
   }
+  grid_.remove(runs_);
 
-  if (matches.size() > 0)
+  if (matches_.size() > 0)
     state_ = state_removing;
 
-  return matches;
+  return matches_;
+}
+
+
+NoDice::Pattern NoDice::Board::
+win_pattern(std::size_t i) const
+{
+  return groups_[i].pattern;
+}
+
+
+void NoDice::Board::
+record_score(std::vector<int> const& rolls, int bonus)
+{
+  history_.add_score(rolls, bonus);
+}
+
+
+void NoDice::Board::
+end_move()
+{
+  history_.end_move();
+}
+
+
+NoDice::History const& NoDice::Board::
+history() const
+{ return history_; }
+
+
+/**
+ * Only the cells the turn changed get new objects, so stepping back through
+ * a long game on a big board costs no more than the moves themselves did.
+ */
+int NoDice::Board::
+undo()
+{
+  int const score = history_.undo(grid_, changed_);
+  for (auto const& p: changed_)
+    create_object(p);
+  return score;
+}
+
+
+int NoDice::Board::
+redo()
+{
+  int const score = history_.redo(grid_, changed_);
+  for (auto const& p: changed_)
+    create_object(p);
+  return score;
+}
+
+
+void NoDice::Board::
+legal_moves(MoveList& moves) const
+{
+  grid_.find_winning_swaps(moves);
+}
+
+
+bool NoDice::Board::
+has_legal_move() const
+{
+  return grid_.has_winning_swap();
+}
+
+
+/**
+ * Every object is rebuilt since the shapes have all moved.
+ */
+bool NoDice::Board::
+reshuffle()
+{
+  history_.begin_rearrange(grid_);
+  if (!grid_.rearrange())
+    return false;
+
+  history_.end_rearrange(grid_);
+  for (int y = 0; y < config_->board_size(); ++y)
+  {
+    for (int x = 0; x < config_->board_size(); ++x)
+    {
+      create_object(Vector2i(x, y));
+    }
+  }
+  return true;
 }
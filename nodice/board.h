@@ -23,8 +23,15 @@
 #ifndef NODICE_BOARD_H
 #define NODICE_BOARD_H 1
 
+#include "nodice/animation.h"
+#include "nodice/grid.h"
+#include "nodice/history.h"
+#include "nodice/instancebatch.h"
 #include "nodice/maths.h"
 #include "nodice/object.h"
+#include "nodice/pattern.h"
+#include "nodice/threadpool.h"
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -35,15 +42,33 @@ namespace NoDice
 
   /**
    * The playing surface.
+   *
+   * The rules of the game are played out on a Grid of shape IDs.  The board
+   * drives the grid and keeps an object for each cell to show it, animating
+   * the objects to catch up with each change the grid makes.
    */
   class Board
   {
+  public:
+    typedef Grid::MoveList MoveList;
+
   public:
     Board(Config const* config);
 
-    ObjectPtr const&
+    Object&
+    at(int x, int y);
+
+    Object const&
     at(int x, int y) const;
 
+    /** Gets the grid the game is played on. */
+    Grid const&
+    grid() const;
+
+    /** Gets the source of random numbers the game is played with. */
+    Random&
+    random();
+
     void
     update();
 
@@ -62,34 +87,129 @@ namespace NoDice
     bool
     is_replacing() const;
 
-    ObjectBrace
+    /**
+     * Turns the board a quarter turn clockwise, so that the dice fall towards
+     * what was its left-hand side.  The dice move to their new cells straight
+     * away, and the board is drawn swinging round to meet them.
+     */
+    void
+    start_rotating();
+
+    bool
+    is_rotating() const;
+
+    /**
+     * Finds the new matches on the board and starts them disappearing.
+     * @returns the objects in each match, good until the next call
+     *
+     * Runs of the same shape that cross or touch make a single match, with
+     * each object in it once.
+     */
+    ObjectBrace const&
     find_wins();
 
+    /** Gets the pattern made by match @p i from the last call to find_wins(). */
+    Pattern
+    win_pattern(std::size_t i) const;
+
+    /**
+     * Records the score of the matches from the last call to find_wins() in
+     * the history.
+     * @param[in] rolls the roll of each die, in the order find_wins() gave them
+     * @param[in] bonus the score on top of the rolls
+     */
+    void
+    record_score(std::vector<int> const& rolls, int bonus);
+
+    /** Marks the end of a move, once the board has settled after it. */
+    void
+    end_move();
+
+    /** Gets the history of the turns played on the board. */
+    History const&
+    history() const;
+
+    /**
+     * Takes back the last turn, putting the dice straight back where they were.
+     * @returns the score the turn made
+     */
+    int
+    undo();
+
+    /**
+     * Plays the last turn undone over again, putting the dice straight where
+     * they ended up.
+     * @returns the score the turn made
+     */
+    int
+    redo();
+
+    /**
+     * Finds every swap of neighbouring cells that would make a match.
+     * @param[out] moves receives the pairs of cells to swap
+     */
+    void
+    legal_moves(MoveList& moves) const;
+
+    /** Indicates if there is any swap that would make a match. */
+    bool
+    has_legal_move() const;
+
+    /**
+     * Shuffles the dice into a new layout with no matches and at least one
+     * legal move.
+     * @returns false, leaving the board as it was, if the dice cannot be laid
+     *          out that way
+     */
+    bool
+    reshuffle();
+
   private:
-    ObjectPtr& at(const Vector2i& point);
+    ObjectHandle& handle_at(const Vector2i& point);
+
+    ObjectHandle handle_at(const Vector2i& point) const;
+
+    void
+    create_object(const Vector2i& point);
 
   private:
     typedef std::vector<Vector2i>         RemovalQueue;
-    typedef std::pair<Vector2i, Vector2i> MovePair;
-    typedef std::vector<MovePair>         FallingQueue;
-    typedef std::vector<Vector2i>         CreateQueue;
+    typedef Grid::FallList                FallingQueue;
+    typedef Grid::CellList                CreateQueue;
+    typedef Grid::Run                     Run;
+    typedef Grid::RunList                 RunList;
 
     enum State
     {
       state_idle,
       state_swapping,
       state_removing,
-      state_falling
+      state_falling,
+      state_rotating
     };
 
-    Config const*  config_;
-    ObjectBag      objects_;
-    State          state_;
-    float          swap_step_;
-    Vector2i       swap_obj_[2];
-    RemovalQueue   removal_queue_;
-    FallingQueue   falling_queue_;
-    CreateQueue    create_queue_;
+    Config const*               config_;
+    std::unique_ptr<ThreadPool> pool_;
+    Grid                        grid_;
+    ObjectPool                  objects_;
+    std::vector<ObjectHandle>   handles_;
+    Animation                   animation_;
+    Random                      spin_random_;
+    RunList                     runs_;
+    PatternMatcher              matcher_;
+    MatchGroupList              groups_;
+    ObjectBrace                 matches_;
+    State                       state_;
+    float                       swap_step_;
+    Vector2i                    swap_obj_[2];
+    bool                        is_move_pending_;
+    History                     history_;
+    Grid::CellList              changed_;
+    float                       rotation_;  ///< degrees left to swing round
+    mutable InstanceBatch       batch_;
+    RemovalQueue                removal_queue_;
+    FallingQueue                falling_queue_;
+    CreateQueue                 create_queue_;
   };
 } // namespace NoDice
 
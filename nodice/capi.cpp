@@ -0,0 +1,287 @@
+/**
+ * @file nodice/capi.cpp
+ * @brief Implemntation of the no-dice rules library.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/capi.h"
+
+#include "nodice/cascade.h"
+#include "nodice/dice.h"
+#include "nodice/environment.h"
+#include "nodice/grid.h"
+#include <exception>
+
+
+struct nodice_board
+{
+  nodice_board(int size, int shape_count, uint64_t seed)
+  : grid(size, shape_count, seed)
+  { }
+
+  NoDice::Grid                   grid;
+  NoDice::MoveResult             result;
+  mutable NoDice::Grid::MoveList moves;
+};
+
+
+struct nodice_batch
+{
+  nodice_batch(int board_count, int size, int shape_count, uint64_t seed)
+  : environment(board_count, size, shape_count, seed)
+  { }
+
+  NoDice::Environment environment;
+};
+
+
+namespace
+{
+  /** Every shape has to be a die the scoring knows how to roll. */
+  static const int max_shape_count = NoDice::die_count;
+
+  bool
+  is_valid_game(int size, int shape_count)
+  {
+    return size >= 3 && shape_count >= 4 && shape_count <= max_shape_count;
+  }
+
+  /** Works out the two cells a move swaps, if they are both on the grid. */
+  bool
+  decode_move(NoDice::Grid const& grid, int32_t move,
+              NoDice::Vector2i& p1, NoDice::Vector2i& p2)
+  {
+    int const size = grid.size();
+    if (move < 0 || move >= 2 * size * size)
+      return false;
+    p1.set((move / 2) % size, (move / 2) / size);
+    p2 = p1;
+    if (move % 2 == 0)
+      ++p2.x;
+    else
+      ++p2.y;
+    return p2.x < size && p2.y < size;
+  }
+
+  int32_t
+  encode_move(NoDice::Grid const& grid, NoDice::Grid::Move const& move)
+  {
+    int const cell = move.first.x + move.first.y * grid.size();
+    return cell * 2 + (move.second.y > move.first.y ? 1 : 0);
+  }
+} // anonymous namespace
+
+
+int
+nodice_api_version(void)
+{
+  return NODICE_API_VERSION;
+}
+
+
+nodice_board*
+nodice_board_create(int size, int shape_count, uint64_t seed)
+{
+  if (!is_valid_game(size, shape_count))
+    return NULL;
+  try
+  {
+    nodice_board* board = new nodice_board(size, shape_count, seed);
+    board->grid.generate();
+    return board;
+  }
+  catch (std::exception const&)
+  {
+    return NULL;
+  }
+}
+
+
+void
+nodice_board_destroy(nodice_board* board)
+{
+  delete board;
+}
+
+
+void
+nodice_board_seed(nodice_board* board, uint64_t seed)
+{
+  board->grid.random().seed(seed);
+}
+
+
+int
+nodice_board_size(nodice_board const* board)
+{
+  return board->grid.size();
+}
+
+
+void
+nodice_board_generate(nodice_board* board)
+{
+  board->grid.generate();
+}
+
+
+void
+nodice_board_read(nodice_board const* board, int8_t* cells)
+{
+  NoDice::Grid const& grid = board->grid;
+  for (int y = 0; y < grid.size(); ++y)
+  {
+    for (int x = 0; x < grid.size(); ++x)
+      *cells++ = grid.at(x, y);
+  }
+}
+
+
+int
+nodice_board_write(nodice_board* board, int8_t const* cells)
+{
+  NoDice::Grid& grid = board->grid;
+  int const cell_count = grid.size() * grid.size();
+  for (int i = 0; i < cell_count; ++i)
+  {
+    if (cells[i] < NoDice::no_shape || cells[i] >= grid.shape_count())
+      return NODICE_ERROR_ARGUMENT;
+  }
+  for (int i = 0; i < cell_count; ++i)
+    grid.set(i % grid.size(), i / grid.size(), cells[i]);
+  return 0;
+}
+
+
+uint64_t
+nodice_board_hash(nodice_board const* board)
+{
+  return board->grid.hash();
+}
+
+
+int
+nodice_board_swap(nodice_board* board, int32_t move)
+{
+  NoDice::Vector2i p1, p2;
+  if (!decode_move(board->grid, move, p1, p2))
+    return NODICE_ERROR_ARGUMENT;
+  board->grid.swap(p1, p2);
+  return 0;
+}
+
+
+int
+nodice_board_resolve(nodice_board* board)
+{
+  NoDice::resolve_cascade(board->grid, board->result);
+  return board->result.score;
+}
+
+
+int
+nodice_board_move(nodice_board* board, int32_t move)
+{
+  NoDice::Vector2i p1, p2;
+  if (!decode_move(board->grid, move, p1, p2))
+    return NODICE_ERROR_ARGUMENT;
+  NoDice::resolve_move(board->grid, p1, p2, board->result);
+  return board->result.score;
+}
+
+
+int
+nodice_board_play(nodice_board* board, int32_t const* moves, int count,
+                  int32_t* scores)
+{
+  int total = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    int const score = nodice_board_move(board, moves[i]);
+    if (scores)
+      scores[i] = score;
+    if (score > 0)
+      total += score;
+  }
+  return total;
+}
+
+
+int
+nodice_board_winning_moves(nodice_board const* board, int32_t* moves,
+                           int capacity)
+{
+  NoDice::Grid::MoveList& found = board->moves;
+  board->grid.find_winning_swaps(found);
+  for (int i = 0; moves && i < capacity && i < int(found.size()); ++i)
+    moves[i] = encode_move(board->grid, found[i]);
+  return int(found.size());
+}
+
+
+nodice_batch*
+nodice_batch_create(int board_count, int size, int shape_count, uint64_t seed)
+{
+  if (board_count < 1 || !is_valid_game(size, shape_count))
+    return NULL;
+  try
+  {
+    return new nodice_batch(board_count, size, shape_count, seed);
+  }
+  catch (std::exception const&)
+  {
+    return NULL;
+  }
+}
+
+
+void
+nodice_batch_destroy(nodice_batch* batch)
+{
+  delete batch;
+}
+
+
+int
+nodice_batch_board_count(nodice_batch const* batch)
+{
+  return batch->environment.board_count();
+}
+
+
+void
+nodice_batch_reset(nodice_batch* batch, int board)
+{
+  batch->environment.reset(board);
+}
+
+
+void
+nodice_batch_step(nodice_batch* batch, int32_t const* moves,
+                  int32_t* rewards, uint8_t* is_done)
+{
+  batch->environment.step(moves, rewards, is_done);
+}
+
+
+void
+nodice_batch_read(nodice_batch const* batch, int8_t* cells)
+{
+  batch->environment.observe(cells);
+}
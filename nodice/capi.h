@@ -0,0 +1,207 @@
+/**
+ * @file nodice/capi.h
+ * @brief Public interface of the no-dice rules library.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_CAPI_H
+#define NODICE_CAPI_H 1
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup capi The rules library
+ *
+ * A plain C interface to the rules of the game, with no video, windowing or
+ * font dependencies, for driving games from other programs and languages.
+ *
+ * A move is given as one number: the cell number (x + y * size) times 2, plus
+ * 0 to swap with the cell to the right or 1 to swap with the cell above.
+ * Cells are read and written a row at a time from the bottom row up, one
+ * shape ID per byte, with -1 for an empty cell.
+ *
+ * Functions that can fail return a negative number (or NULL) rather than
+ * crashing the caller.  None of them keep hold of the caller's buffers.
+ * @{
+ */
+
+/** The version of this interface, bumped whenever it changes. */
+#define NODICE_API_VERSION 1
+
+/** A move that does nothing. */
+#define NODICE_NO_MOVE (-1)
+
+/** The error returned when the arguments make no sense. */
+#define NODICE_ERROR_ARGUMENT (-1)
+
+/** A single game. */
+typedef struct nodice_board nodice_board;
+
+/** A batch of games played in step with each other. */
+typedef struct nodice_batch nodice_batch;
+
+/** Gets the NODICE_API_VERSION the library was built with. */
+int
+nodice_api_version(void);
+
+/**
+ * Creates a board and starts a game on it with no matches and at least one
+ * move that makes one.
+ * @param size        the number of cells along each side, 3 or more
+ * @param shape_count the number of different shapes, from 4 to 5: one for
+ *                    each kind of die, d4 to d20
+ * @param seed        the seed for the board's random numbers
+ * @returns the new board, or NULL if the arguments make no sense or memory
+ *          runs out
+ */
+nodice_board*
+nodice_board_create(int size, int shape_count, uint64_t seed);
+
+/** Destroys a board.  NULL is ignored. */
+void
+nodice_board_destroy(nodice_board* board);
+
+/** Restarts a board's random numbers from a seed. */
+void
+nodice_board_seed(nodice_board* board, uint64_t seed);
+
+/** Gets the number of cells along each side of a board. */
+int
+nodice_board_size(nodice_board const* board);
+
+/** Starts a new game on a board. */
+void
+nodice_board_generate(nodice_board* board);
+
+/**
+ * Copies the shapes on a board into a buffer.
+ * @param cells room for size * size shapes
+ */
+void
+nodice_board_read(nodice_board const* board, int8_t* cells);
+
+/**
+ * Sets every cell on a board from a buffer.
+ * @param cells size * size shapes, each -1 or from 0 to shape_count - 1
+ * @returns 0, or NODICE_ERROR_ARGUMENT if a shape is out of range
+ */
+int
+nodice_board_write(nodice_board* board, int8_t const* cells);
+
+/** Gets the Zobrist hash of the shapes on a board. */
+uint64_t
+nodice_board_hash(nodice_board const* board);
+
+/**
+ * Swaps two cells without playing out any matches.
+ * @returns 0, or NODICE_ERROR_ARGUMENT for a move off the board
+ */
+int
+nodice_board_swap(nodice_board* board, int32_t move);
+
+/**
+ * Plays out the matches on a board and everything that follows.
+ * @returns the score, rolling the dice as the game does
+ */
+int
+nodice_board_resolve(nodice_board* board);
+
+/**
+ * Makes a move and plays out the cascade.  A move that makes no match is
+ * swapped back.
+ * @returns the score, 0 for a move that makes no match, or
+ *          NODICE_ERROR_ARGUMENT for a move off the board
+ */
+int
+nodice_board_move(nodice_board* board, int32_t move);
+
+/**
+ * Makes a series of moves, one after another.
+ * @param moves  the moves to make
+ * @param count  the number of moves
+ * @param scores receives the score for each move, as nodice_board_move()
+ *               would return it; may be NULL
+ * @returns the total score of the moves that were on the board
+ */
+int
+nodice_board_play(nodice_board* board, int32_t const* moves, int count,
+                  int32_t* scores);
+
+/**
+ * Finds every move that would make a match, in order of cell number.
+ * @param moves    receives up to @p capacity moves; may be NULL
+ * @param capacity the room in @p moves
+ * @returns the number of moves there are, which may be more than @p capacity
+ */
+int
+nodice_board_winning_moves(nodice_board const* board, int32_t* moves,
+                           int capacity);
+
+/**
+ * Creates a batch of boards, each with a game started on it.  Board b is
+ * seeded with seed + b.
+ * @returns the new batch, or NULL if the arguments make no sense or memory
+ *          runs out
+ */
+nodice_batch*
+nodice_batch_create(int board_count, int size, int shape_count, uint64_t seed);
+
+/** Destroys a batch.  NULL is ignored. */
+void
+nodice_batch_destroy(nodice_batch* batch);
+
+/** Gets the number of boards in a batch. */
+int
+nodice_batch_board_count(nodice_batch const* batch);
+
+/** Starts a new game on one board of a batch. */
+void
+nodice_batch_reset(nodice_batch* batch, int board);
+
+/**
+ * Makes one move on every board in a batch and plays out all the cascades.
+ * Each board's reward is the number of dice its move cleared, with each step
+ * of the cascade counting one more than the step before.
+ * @param moves   one move per board
+ * @param rewards receives one reward per board
+ * @param is_done receives 1 for each board with no move left, else 0
+ */
+void
+nodice_batch_step(nodice_batch* batch, int32_t const* moves,
+                  int32_t* rewards, uint8_t* is_done);
+
+/**
+ * Copies the shapes on every board in a batch into a buffer, one whole board
+ * after another.
+ * @param cells room for board_count * size * size shapes
+ */
+void
+nodice_batch_read(nodice_batch const* batch, int8_t* cells);
+
+/** @} */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NODICE_CAPI_H */
@@ -0,0 +1,87 @@
+/**
+ * @file nodice/cascade.cpp
+ * @brief Implemntation of the nodice/cascade module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/cascade.h"
+
+#include <utility>
+
+
+bool NoDice::
+resolve_move(Grid& grid, const Vector2i& p1, const Vector2i& p2,
+             MoveResult& result)
+{
+  grid.swap(p1, p2);
+  resolve_cascade(grid, result);
+  if (result.steps.empty())
+  {
+    grid.swap(p1, p2);
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * This is the same remove-fall-refill loop that Board animates, with nothing
+ * to wait for between the steps, and the same scoring as the game.  The
+ * matcher is only set up once there is something to match.
+ */
+void NoDice::
+resolve_cascade(Grid& grid, MoveResult& result)
+{
+  Grid::RunList  runs;
+  Grid::FallList falls;
+  Grid::CellList empties;
+  MatchGroupList groups;
+
+  result.steps.clear();
+  result.score = 0;
+  grid.find_matches(runs);
+  if (runs.empty())
+    return;
+
+  PatternMatcher matcher(grid.size());
+  for (int multiplier = 0; !runs.empty(); ++multiplier)
+  {
+    matcher.group(grid, runs, groups);
+    CascadeStep step;
+    step.score = 0;
+    for (auto& group: groups)
+    {
+      Match match{ group.shape, group.pattern, std::move(group.cells),
+                   multiplier + pattern_bonus(group.pattern) };
+      for (std::size_t i = 0; i < match.cells.size(); ++i)
+      {
+        match.score += roll_die(match.shape, grid.random());
+      }
+      step.score += match.score;
+      step.matches.push_back(std::move(match));
+    }
+    result.score += step.score;
+    result.steps.push_back(std::move(step));
+
+    grid.remove(runs);
+    grid.collapse(falls, empties);
+    grid.refill(empties);
+    grid.find_matches(runs);
+  }
+}
@@ -0,0 +1,88 @@
+/**
+ * @file nodice/cascade.h
+ * @brief Public interface of the nodice/cascade module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_CASCADE_H
+#define NODICE_CASCADE_H 1
+
+#include "nodice/grid.h"
+#include "nodice/maths.h"
+#include "nodice/pattern.h"
+#include <vector>
+
+
+namespace NoDice
+{
+  /** A group of matching dice, the pattern they make, and what it scored. */
+  struct Match
+  {
+    ShapeId        shape;
+    Pattern        pattern;
+    Grid::CellList cells;
+    int            score;
+  };
+
+  typedef std::vector<Match> MatchList;
+
+  /** One step of a cascade: everything that matched at once. */
+  struct CascadeStep
+  {
+    MatchList matches;
+    int       score;
+  };
+
+  typedef std::vector<CascadeStep> CascadeStepList;
+
+  /** What happened as a result of a move. */
+  struct MoveResult
+  {
+    CascadeStepList steps;
+    int             score;
+  };
+
+  /**
+   * Makes a move and plays out the whole cascade that follows in one go.
+   * @param[in,out] grid   the grid to play on
+   * @param[in]     p1     one of the cells to swap
+   * @param[in]     p2     the other cell to swap
+   * @param[out]    result receives the matches and score of each step
+   * @returns true if the move made a match, false if it was swapped back
+   *
+   * Runs that touch are merged into groups the way the game merges them (see
+   * PatternMatcher).  Each group scores a roll of each of its dice, plus the
+   * number of steps into the cascade it was found, plus the bonus for its
+   * pattern, the same as in the game.
+   */
+  bool
+  resolve_move(Grid& grid, const Vector2i& p1, const Vector2i& p2,
+               MoveResult& result);
+
+  /**
+   * Plays out the matches already on a grid and everything that follows.
+   * @param[in,out] grid   the grid to play on
+   * @param[out]    result receives the matches and score of each step
+   */
+  void
+  resolve_cascade(Grid& grid, MoveResult& result);
+
+} // namespace NoDice
+
+#endif // NODICE_CASCADE_H
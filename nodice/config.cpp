@@ -24,6 +24,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <iostream>
 
 #ifndef NODICE_SRC_DIR
@@ -103,7 +104,8 @@ namespace
  * appropriately.
  *
  * This contains a local reimplementation of getopt(3) because not all target
- * platforms support the POSIX API.
+ * platforms support the POSIX API.  Long options are only recognized in the
+ * form --name=value or --name value.
  */
 NoDice::Config::
 Config(int argc, char* argv[])
@@ -111,9 +113,11 @@ Config(int argc, char* argv[])
 , is_debug_mode_(false)
 , is_fullscreen_(false)
 , is_small_window_(false)
+, is_console_mode_(false)
 , screen_width_(640)
 , screen_height_(480)
 , board_size_(8)
+, seed_(std::time(NULL))
 , asset_search_path_(get_asset_search_path())
 {
   for (int i = 0; i < argc; ++i)
@@ -123,6 +127,32 @@ Config(int argc, char* argv[])
       char c = *(argv[i] + 1);
       switch (c)
       {
+        case '-':
+        {
+          char const* name = argv[i] + 2;
+          char const* value = std::strchr(name, '=');
+          std::string const option = value ? std::string(name, value) : name;
+          if (option != "seed")
+          {
+            std::cerr << "unrecognized option --" << option << "\n";
+            break;
+          }
+          char const* opt = getarg(value ? value + 1 : "",
+                                   (i + 1 < argc) ? argv[i+1] : NULL, i);
+          char* end = NULL;
+          if (opt != NULL)
+            seed_ = std::strtoull(opt, &end, 0);
+          if (opt == NULL || end == opt || *end != '\0')
+            std::cerr << "error parsing arg --seed\n";
+          break;
+        }
+
+        case 'c':
+        {
+          is_console_mode_ = true;
+          break;
+        }
+
         case 'd':
         {
           is_debug_mode_ = true;
@@ -185,6 +215,13 @@ is_small_window() const
 }
 
 
+bool NoDice::Config::
+is_console_mode() const
+{
+  return is_console_mode_;
+}
+
+
 int NoDice::Config::
 screen_width() const
 {
@@ -237,6 +274,11 @@ set_board_size(int size)
 }
 
 
+std::uint64_t NoDice::Config::
+seed() const
+{ return seed_; }
+
+
 std::vector<std::string> const& NoDice::Config::
 asset_search_path() const
 {
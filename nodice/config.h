@@ -23,6 +23,7 @@
 #ifndef NODICE_CONFIG_H
 #define NODICE_CONFIG_H 1
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,10 @@ namespace NoDice
     bool
     is_small_window() const;
 
+    /** Indicates if the game is played on the console with no video. */
+    bool
+    is_console_mode() const;
+
     /** Gets the currently selected screen width (in pixels). */
     int
     screen_width() const;
@@ -77,6 +82,13 @@ namespace NoDice
     void
     set_board_size(int size);
 
+    /**
+     * Gets the seed the game's random numbers start from.  It is taken from
+     * the clock unless one is given with --seed, so a game can be replayed.
+     */
+    std::uint64_t
+    seed() const;
+
     /** Gets the search path for assets. */
     std::vector<std::string> const&
     asset_search_path() const;
@@ -90,9 +102,11 @@ namespace NoDice
     bool                     is_debug_mode_;
     bool                     is_fullscreen_;
     bool                     is_small_window_;
+    bool                     is_console_mode_;
     int                      screen_width_;
     int                      screen_height_;
     int                      board_size_;
+    std::uint64_t            seed_;
     std::vector<std::string> asset_search_path_;
   };
 } // namespace NoDice
@@ -0,0 +1,115 @@
+/**
+ * @file nodice/console.cpp
+ * @brief Implemntation of the nodice/console module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/console.h"
+
+#include <cstdlib>
+#include "nodice/cascade.h"
+#include "nodice/config.h"
+#include "nodice/grid.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+  /** Writes out the grid, top row first, one digit per shape. */
+  void
+  print_grid(NoDice::Grid const& grid, std::ostream& out)
+  {
+    for (int y = grid.size() - 1; y >= 0; --y)
+    {
+      for (int x = 0; x < grid.size(); ++x)
+      {
+        out << int(grid.at(x, y));
+      }
+      out << "\n";
+    }
+  }
+
+  bool
+  is_on_grid(NoDice::Grid const& grid, NoDice::Vector2i const& p)
+  {
+    return p.x >= 0 && p.x < grid.size() && p.y >= 0 && p.y < grid.size();
+  }
+} // anonymous namespace
+
+
+int NoDice::
+run_console(Config const& config, std::istream& in, std::ostream& out)
+{
+  Grid grid(config.board_size(), die_count, config.seed());
+  MoveResult result;
+  grid.generate();
+  print_grid(grid, out);
+
+  int total = 0;
+  int line_number = 0;
+  bool is_over = !grid.has_winning_swap();
+  std::string line;
+  while (!is_over && std::getline(in, line))
+  {
+    ++line_number;
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream istr(line);
+    Vector2i p1, p2;
+    if (!(istr >> p1.x >> p1.y >> p2.x >> p2.y)
+     || !is_on_grid(grid, p1) || !is_on_grid(grid, p2)
+     || std::abs(p1.x - p2.x) + std::abs(p1.y - p2.y) != 1)
+    {
+      std::cerr << "line " << line_number << ": not a move: '" << line << "'\n";
+      continue;
+    }
+
+    out << "move " << p1.x << " " << p1.y << " " << p2.x << " " << p2.y << ":";
+    if (!resolve_move(grid, p1, p2, result))
+    {
+      out << " no match\n";
+      continue;
+    }
+    out << "\n";
+    for (std::size_t i = 0; i < result.steps.size(); ++i)
+    {
+      out << "  step " << i << ":";
+      for (auto const& match: result.steps[i].matches)
+      {
+        out << " " << match.cells.size() << "x" << int(match.shape)
+            << "@" << match.cells[0].x << "," << match.cells[0].y
+            << "[" << pattern_name(match.pattern) << "]"
+            << "=" << match.score;
+      }
+      out << "\n";
+    }
+    total += result.score;
+    out << "  score " << result.score << " total " << total << "\n";
+    is_over = !grid.has_winning_swap();
+  }
+
+  if (is_over)
+    out << "no moves left\n";
+  print_grid(grid, out);
+  out << "total " << total << "\n";
+  return 0;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file nodice/console.h
+ * @brief Public interface of the nodice/console module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_CONSOLE_H
+#define NODICE_CONSOLE_H 1
+
+#include <iosfwd>
+
+
+namespace NoDice
+{
+  class Config;
+
+  /**
+   * Plays a game with no video at all.
+   * @param[in]  config the game configuration
+   * @param[in]  in     a stream of moves, one "x1 y1 x2 y2" per line
+   * @param[out] out    receives the grid, and the matches and score of each move
+   *
+   * Each move and the cascade following it is played out in one go, with no
+   * animation.  Blank lines and lines starting with '#' are ignored.  The
+   * game ends early if no swap would make a match.
+   *
+   * @returns the process exit code
+   */
+  int
+  run_console(Config const& config, std::istream& in, std::ostream& out);
+
+} // namespace NoDice
+
+#endif // NODICE_CONSOLE_H
@@ -20,7 +20,6 @@
 #include "nodice/d12.h"
 
 #include <cmath>
-#include <cstdlib>
 #include <iostream>
 #include "nodice/maths.h"
 
@@ -34,7 +33,7 @@ namespace
 
 NoDice::D12::
 D12()
-: Shape("d12", NoDice::Colour(0.3f, 0.5f, 1.0f, 0.80))
+: Shape(die_d12, "d12", NoDice::Colour(0.3f, 0.5f, 1.0f, 0.80))
 {
   // Magic precomputed vertexes of the unit-sphere dodecahedron
   static const Vector3f vertex[] = 
@@ -85,7 +84,7 @@ D12()
   static const int vertex_count = num_faces * triangles_per_face
                                             * vertexes_per_triangle;
 
-  // A temporary buffer with which the VBO will be initialized
+  // A temporary buffer with which the mesh will be initialized
   GLfloat shape[row_width * vertex_count];
   GLfloat* p = shape;
   for (int i = 0; i < num_faces; ++i)
@@ -93,47 +92,5 @@ D12()
     pentagon(vertex, index[i], p);
   }
 
-  glGenBuffers(1, &m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(shape), shape, GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  m_vertexCount = vertex_count;
+  setMesh(shape, vertex_count);
 } 
-
-
-NoDice::D12::
-~D12()
-{
-  glDeleteBuffers(1, &m_vbo);
-} 
-
-
-int NoDice::D12::
-score()
-{
-  return std::rand() % 12 + 1;
-}
-
-
-void NoDice::D12::
-draw() const
-{
-  static const int stride = row_width * sizeof(GLfloat);
-  static const GLfloat* shape_verteces = 0;
-  static const GLfloat* shape_normals = shape_verteces + coords_per_vertex;
-
-  glEnable(GL_NORMALIZE);
-  glDisable(GL_CULL_FACE); // for transparency -- move to object
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_NORMAL_ARRAY);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glNormalPointer(GL_FLOAT, stride, shape_normals);
-  glVertexPointer(coords_per_vertex, GL_FLOAT, stride, shape_verteces);
-  glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glDisableClientState(GL_NORMAL_ARRAY);
-  glDisableClientState(GL_VERTEX_ARRAY);
-  glDisable(GL_NORMALIZE);
-}
-
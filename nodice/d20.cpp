@@ -20,7 +20,6 @@
 #include "nodice/d20.h"
 
 #include <cmath>
-#include <cstdlib>
 #include "nodice/maths.h"
 
 
@@ -37,7 +36,7 @@ namespace
  */
 NoDice::D20::
 D20()
-: Shape("d20", NoDice::Colour(0.8f, 0.8f, 0.8f, 0.60))
+: Shape(die_d20, "d20", NoDice::Colour(0.8f, 0.8f, 0.8f, 0.60))
 {
   // t = (1+sqrt(5))/2, tau = t / sqrt(1 + t^2)
   static const GLfloat tau = 0.8506508084f;
@@ -92,7 +91,7 @@ D20()
   static const int vertex_count = num_faces * triangles_per_face
                                             * vertexes_per_triangle;
 
-  // A temporary buffer with which the VBO will be initialized
+  // A temporary buffer with which the mesh will be initialized
   GLfloat shape[row_width * vertex_count];
   GLfloat* p = shape;
   for (int i = 0; i < num_faces; ++i)
@@ -100,49 +99,5 @@ D20()
     triangle(vertex, index[i], p);
   }
 
-  // Create the VBO.
-  glGenBuffers(1, &m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(shape), shape, GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Remember the size of the VBO.
-  m_vertexCount = vertex_count;
+  setMesh(shape, vertex_count);
 } 
-
-
-NoDice::D20::
-~D20()
-{
-  glDeleteBuffers(1, &m_vbo);
-} 
-
-
-int NoDice::D20::
-score()
-{
-  return std::rand() % 20 + 1;
-}
-
-
-void NoDice::D20::
-draw() const
-{
-  static const int stride = row_width * sizeof(GLfloat);
-  static const GLfloat* shape_verteces = 0;
-  static const GLfloat* shape_normals = shape_verteces + coords_per_vertex;
-
-  glEnable(GL_NORMALIZE);
-  glDisable(GL_CULL_FACE); // for transparency -- move to object
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_NORMAL_ARRAY);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glNormalPointer(GL_FLOAT, stride, shape_normals);
-  glVertexPointer(coords_per_vertex, GL_FLOAT, stride, shape_verteces);
-  glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glDisableClientState(GL_NORMAL_ARRAY);
-  glDisableClientState(GL_VERTEX_ARRAY);
-  glDisable(GL_NORMALIZE);
-}
-
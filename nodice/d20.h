@@ -35,13 +35,6 @@ namespace NoDice
   {
   public:
     D20();
-    ~D20();
-    int score();
-    void draw() const;
-
-  private:
-    GLuint  m_vbo;
-    GLsizei m_vertexCount;
   };
 } // namespace noDice
 
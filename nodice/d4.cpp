@@ -20,7 +20,6 @@
 #include "nodice/d4.h"
 
 #include <cmath>
-#include <cstdlib>
 #include "nodice/maths.h"
 
 
@@ -33,7 +32,7 @@ namespace
 
 NoDice::D4::
 D4()
-: Shape("d4", NoDice::Colour(1.0f, 1.0f, 0.0f, 0.60f))
+: Shape(die_d4, "d4", NoDice::Colour(1.0f, 1.0f, 0.0f, 0.60f))
 {
   static const GLfloat half = 0.5773502692; // for tetrahedron in unit sphere
 
@@ -61,7 +60,7 @@ D4()
   static const int vertex_count = num_faces * triangles_per_face
                                             * vertexes_per_triangle;
 
-  // A temporary buffer with which the VBO will be initialized
+  // A temporary buffer with which the mesh will be initialized
   GLfloat shape[row_width * vertex_count];
   GLfloat* p = shape;
   for (int i = 0; i < num_faces; ++i)
@@ -69,48 +68,5 @@ D4()
     triangle(vertex, index[i], p);
   }
 
-  glGenBuffers(1, &m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(shape), shape, GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Remember the size of the VBO.
-  m_vertexCount = vertex_count;
+  setMesh(shape, vertex_count);
 } 
-
-
-NoDice::D4::
-~D4()
-{
-  glDeleteBuffers(1, &m_vbo);
-} 
-
-
-int NoDice::D4::
-score()
-{
-  return std::rand() % 4 + 1;
-}
-
-
-void NoDice::D4::
-draw() const
-{
-  static const int stride = row_width * sizeof(GLfloat);
-  static const GLfloat* shape_verteces = 0;
-  static const GLfloat* shape_normals = shape_verteces + coords_per_vertex;
-
-  glEnable(GL_NORMALIZE);
-  glDisable(GL_CULL_FACE); // for transparency -- move to object
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_NORMAL_ARRAY);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glNormalPointer(GL_FLOAT, stride, shape_normals);
-  glVertexPointer(coords_per_vertex, GL_FLOAT, stride, shape_verteces);
-  glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glDisableClientState(GL_NORMAL_ARRAY);
-  glDisableClientState(GL_VERTEX_ARRAY);
-  glDisable(GL_NORMALIZE);
-}
-
@@ -19,7 +19,6 @@
  */
 #include "nodice/d6.h"
 
-#include <cstdlib>
 #include "nodice/maths.h"
 
 
@@ -31,7 +30,7 @@ namespace
 
 NoDice::D6::
 D6()
-: Shape("d6", NoDice::Colour(1.0f, 0.0f, 0.1f, 0.40f))
+: Shape(die_d6, "d6", NoDice::Colour(1.0f, 0.0f, 0.1f, 0.40f))
 {
   static const GLfloat bevel = 0.05f;
   static const GLfloat size = 1.0f / std::sqrt(3.0f);
@@ -198,47 +197,5 @@ D6()
     -bsize, -bsize, -size,   0.0f,  0.0f, -1.0f, /* W */
     -bsize,  bsize, -size,   0.0f,  0.0f, -1.0f, /* X */
   };
-  m_vertexCount = (sizeof(cube) / sizeof(GLfloat)) / row_width;
-
-  glGenBuffers(1, &m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  setMesh(cube, (sizeof(cube) / sizeof(GLfloat)) / row_width);
 } 
-
-
-NoDice::D6::
-~D6()
-{
-  glDeleteBuffers(1, &m_vbo);
-} 
-
-
-int NoDice::D6::
-score()
-{
-  return std::rand() % 6 + 1;
-}
-
-
-void NoDice::D6::
-draw() const
-{
-  static const int stride = row_width * sizeof(GLfloat);
-  static const GLfloat* cube_verteces = 0;
-  static const GLfloat* cube_normals = cube_verteces + coords_per_vertex;
-
-  glEnable(GL_NORMALIZE);
-  glDisable(GL_CULL_FACE); // for transparency -- move to object
-  glEnableClientState(GL_VERTEX_ARRAY);
-  glEnableClientState(GL_NORMAL_ARRAY);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glNormalPointer(GL_FLOAT, stride, cube_normals);
-  glVertexPointer(coords_per_vertex, GL_FLOAT, stride, cube_verteces);
-  glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glDisableClientState(GL_NORMAL_ARRAY);
-  glDisableClientState(GL_VERTEX_ARRAY);
-  glDisable(GL_NORMALIZE);
-}
-
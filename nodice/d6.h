@@ -32,13 +32,6 @@ namespace NoDice
   {
   public:
     D6();
-    ~D6();
-    int score();
-    void draw() const;
-
-  private:
-    GLuint  m_vbo;
-    GLsizei m_vertexCount;
   };
 } // namespace noDice
 
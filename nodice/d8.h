@@ -35,13 +35,6 @@ namespace NoDice
   {
   public:
     D8();
-    ~D8();
-    int score();
-    void draw() const;
-
-  private:
-    GLuint  m_vbo;
-    GLsizei m_vertexCount;
   };
 } // namespace noDice
 
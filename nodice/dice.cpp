@@ -0,0 +1,50 @@
+/**
+ * @file nodice/dice.cpp
+ * @brief Implemntation of the nodice/dice module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/dice.h"
+
+
+namespace
+{
+  /**
+   * Faces on each die: d4, d6, d8, d12, d20.  This is the one table of them;
+   * the shapes drawn on screen roll through roll_die() too.
+   */
+  static const int faces[] = { 4, 6, 8, 12, 20 };
+
+  static_assert(sizeof(faces) / sizeof(faces[0]) == NoDice::die_count,
+                "every shape of die needs its number of faces");
+} // anonymous namespace
+
+
+int NoDice::
+die_faces(ShapeId shape)
+{
+  return faces[shape];
+}
+
+
+int NoDice::
+roll_die(ShapeId shape, Random& random)
+{
+  return random.below(faces[shape]) + 1;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file nodice/dice.h
+ * @brief Public interface of the nodice/dice module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_DICE_H
+#define NODICE_DICE_H 1
+
+#include <cstdint>
+#include "nodice/random.h"
+
+
+namespace NoDice
+{
+  /** Identifies the shape of a die. */
+  typedef std::int8_t ShapeId;
+
+  /** The shape of an empty grid cell. */
+  const ShapeId no_shape = -1;
+
+  /** The shapes of die, in the same order as the shape bag. */
+  const ShapeId die_d4  = 0;
+  const ShapeId die_d6  = 1;
+  const ShapeId die_d8  = 2;
+  const ShapeId die_d12 = 3;
+  const ShapeId die_d20 = 4;
+
+  /** The number of different shapes of die. */
+  const int die_count = die_d20 + 1;
+
+  /** Gets the number of faces on the die with a given shape. */
+  int
+  die_faces(ShapeId shape);
+
+  /** Rolls the die with a given shape. */
+  int
+  roll_die(ShapeId shape, Random& random);
+
+} // namespace NoDice
+
+#endif // NODICE_DICE_H
@@ -0,0 +1,388 @@
+/**
+ * @file nodice/environment.cpp
+ * @brief Implemntation of the nodice/environment module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/environment.h"
+
+#include <algorithm>
+#include "nodice/grid.h"
+
+
+/*
+ * The loops across the boards live in these functions so that the rows of
+ * lanes can be passed as restricted parameters.  Left to work out for itself
+ * whether the rows overlap, the compiler will not vectorize them.
+ */
+namespace
+{
+  using NoDice::ShapeId;
+  using NoDice::no_shape;
+
+  /** Marks the lanes where three cells in a row hold the same shape. */
+  std::uint8_t
+  mark_line(int const n,
+            ShapeId const* __restrict__ s0,
+            ShapeId const* __restrict__ s1,
+            ShapeId const* __restrict__ s2,
+            std::uint8_t* __restrict__ m0,
+            std::uint8_t* __restrict__ m1,
+            std::uint8_t* __restrict__ m2)
+  {
+    std::uint8_t any = 0;
+    for (int b = 0; b < n; ++b)
+    {
+      std::uint8_t const is_line = (s0[b] != no_shape)
+                                 & (s0[b] == s1[b])
+                                 & (s0[b] == s2[b]);
+      m0[b] |= is_line;
+      m1[b] |= is_line;
+      m2[b] |= is_line;
+      any |= is_line;
+    }
+    return any;
+  }
+
+  /** Empties the marked lanes of a cell and rewards them. */
+  void
+  remove_lanes(int const n,
+               std::int32_t const weight,
+               std::uint8_t const* __restrict__ marks,
+               ShapeId* __restrict__ shapes,
+               std::int32_t* __restrict__ rewards)
+  {
+    for (int b = 0; b < n; ++b)
+    {
+      rewards[b] += weight * marks[b];
+      shapes[b] = marks[b] ? no_shape : shapes[b];
+    }
+  }
+
+  /** Swaps the lanes where a cell is empty and the one above it is not. */
+  std::uint8_t
+  bubble(int const n, ShapeId* __restrict__ lo, ShapeId* __restrict__ hi)
+  {
+    std::uint8_t moved = 0;
+    for (int b = 0; b < n; ++b)
+    {
+      ShapeId const below = lo[b];
+      ShapeId const above = hi[b];
+      std::uint8_t const is_hole = (below == no_shape) & (above != no_shape);
+      lo[b] = is_hole ? above : below;
+      hi[b] = is_hole ? no_shape : above;
+      moved |= is_hole;
+    }
+    return moved;
+  }
+
+  /** Indicates if a cell is empty in any lane. */
+  bool
+  has_hole(int const n, ShapeId const* __restrict__ shapes)
+  {
+    std::uint8_t any = 0;
+    for (int b = 0; b < n; ++b)
+      any |= (shapes[b] == no_shape);
+    return any != 0;
+  }
+
+  /** Clears the lanes where a shape would make a line with two others. */
+  void
+  clear_if_line(int const n,
+                ShapeId const* __restrict__ moving,
+                ShapeId const* __restrict__ s1,
+                ShapeId const* __restrict__ s2,
+                std::uint8_t* __restrict__ is_done)
+  {
+    for (int b = 0; b < n; ++b)
+    {
+      std::uint8_t const is_line = (moving[b] == s1[b]) & (moving[b] == s2[b]);
+      is_done[b] &= std::uint8_t(is_line ^ 1);
+    }
+  }
+} // anonymous namespace
+
+
+NoDice::Environment::
+Environment(int board_count, int size, int shape_count, Random::result_type seed)
+: board_count_(board_count)
+, size_(size)
+, shape_count_(shape_count)
+, cells_(size * size * board_count, no_shape)
+, marks_(size * size * board_count, 0)
+{
+  randoms_.reserve(board_count);
+  for (int b = 0; b < board_count; ++b)
+  {
+    randoms_.emplace_back(seed + b);
+    reset(b);
+  }
+}
+
+
+int NoDice::Environment::
+board_count() const
+{ return board_count_; }
+
+
+int NoDice::Environment::
+size() const
+{ return size_; }
+
+
+int NoDice::Environment::
+shape_count() const
+{ return shape_count_; }
+
+
+NoDice::Environment::Action NoDice::Environment::
+action(int x, int y, Direction direction) const
+{ return (x + y * size_) * 2 + direction; }
+
+
+NoDice::ShapeId NoDice::Environment::
+at(int board, int x, int y) const
+{ return lanes(x, y)[board]; }
+
+
+/**
+ * A new game is generated on a Grid, which then hands its random numbers
+ * back so the board carries on from where the Grid left off.
+ */
+void NoDice::Environment::
+reset(int board)
+{
+  Grid grid(size_, shape_count_, 0);
+  grid.random() = randoms_[board];
+  grid.generate();
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+      lanes(x, y)[board] = grid.at(x, y);
+  }
+  randoms_[board] = grid.random();
+}
+
+
+/**
+ * The cascades on all the boards are played out together.  A board whose
+ * cascade has finished has nothing marked, so the later passes leave it be.
+ */
+void NoDice::Environment::
+step(Action const* actions, std::int32_t* rewards, std::uint8_t* is_done)
+{
+  std::fill(rewards, rewards + board_count_, 0);
+  for (int b = 0; b < board_count_; ++b)
+  {
+    swap(b, actions[b]);
+  }
+  for (int weight = 1; mark_matches(); ++weight)
+  {
+    remove_marked(weight, rewards);
+    collapse();
+    refill();
+  }
+  for (int b = 0; b < board_count_; ++b)
+  {
+    if (rewards[b] == 0)
+      swap(b, actions[b]);
+  }
+  find_dead_boards(is_done);
+}
+
+
+void NoDice::Environment::
+observe(ShapeId* cells) const
+{
+  int const cell_count = size_ * size_;
+  for (int c = 0; c < cell_count; ++c)
+  {
+    ShapeId const* shapes = &cells_[c * board_count_];
+    for (int b = 0; b < board_count_; ++b)
+      cells[b * cell_count + c] = shapes[b];
+  }
+}
+
+
+NoDice::ShapeId* NoDice::Environment::
+lanes(int x, int y)
+{ return &cells_[(x + y * size_) * board_count_]; }
+
+
+NoDice::ShapeId const* NoDice::Environment::
+lanes(int x, int y) const
+{ return &cells_[(x + y * size_) * board_count_]; }
+
+
+/**
+ * Swaps the cells named by an action on one board.  Each board's action names
+ * a different pair of cells, so moves are made board by board.  An action
+ * that would swap with a cell off the board is treated as no move at all.
+ */
+void NoDice::Environment::
+swap(int board, Action action)
+{
+  if (action < 0 || action >= 2 * size_ * size_)
+    return;
+  int const cell = action / 2;
+  int const x = cell % size_ + (action % 2 == move_right);
+  int const y = cell / size_ + (action % 2 == move_up);
+  if (x >= size_ || y >= size_)
+    return;
+  std::swap(lanes(cell % size_, cell / size_)[board], lanes(x, y)[board]);
+}
+
+
+/**
+ * Marks every cell that is part of a line of 3 or more, for all boards at
+ * once.  Each window of 3 cells along a row or column is checked across all
+ * the boards in one branch-free loop.
+ * @returns true if anything on any board was marked
+ */
+bool NoDice::Environment::
+mark_matches()
+{
+  std::fill(marks_.begin(), marks_.end(), 0);
+  std::uint8_t any = 0;
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      for (int d = 0; d < 2; ++d)
+      {
+        int const dx = 1 - d, dy = d;
+        if (x + 2 * dx >= size_ || y + 2 * dy >= size_)
+          continue;
+        ShapeId const* s0 = lanes(x, y);
+        ShapeId const* s1 = lanes(x + dx, y + dy);
+        ShapeId const* s2 = lanes(x + 2 * dx, y + 2 * dy);
+        any |= mark_line(board_count_, s0, s1, s2,
+                         &marks_[s0 - cells_.data()],
+                         &marks_[s1 - cells_.data()],
+                         &marks_[s2 - cells_.data()]);
+      }
+    }
+  }
+  return any != 0;
+}
+
+
+void NoDice::Environment::
+remove_marked(int weight, std::int32_t* rewards)
+{
+  int const cell_count = size_ * size_;
+  for (int c = 0; c < cell_count; ++c)
+  {
+    remove_lanes(board_count_, weight,
+                 &marks_[c * board_count_], &cells_[c * board_count_], rewards);
+  }
+}
+
+
+/**
+ * Lets the shapes fall by bubbling the holes up each column: one pass up a
+ * column carries a hole all the way to the top, on every board at once, so a
+ * column is done once a pass moves nothing on any board.
+ */
+void NoDice::Environment::
+collapse()
+{
+  for (int x = 0; x < size_; ++x)
+  {
+    for (int pass = 0; pass < size_; ++pass)
+    {
+      std::uint8_t moved = 0;
+      for (int y = 0; y + 1 < size_; ++y)
+        moved |= bubble(board_count_, lanes(x, y), lanes(x, y + 1));
+      if (!moved)
+        break;
+    }
+  }
+}
+
+
+/**
+ * The holes are filled column by column from the top down, the same order
+ * Grid::collapse() lists them in, so each board draws the same shapes a Grid
+ * would.
+ */
+void NoDice::Environment::
+refill()
+{
+  for (int x = 0; x < size_; ++x)
+  {
+    for (int y = size_ - 1; y >= 0; --y)
+    {
+      ShapeId* shapes = lanes(x, y);
+      if (!has_hole(board_count_, shapes))
+        continue;
+      for (int b = 0; b < board_count_; ++b)
+      {
+        if (shapes[b] == no_shape)
+          shapes[b] = randoms_[b].below(shape_count_);
+      }
+    }
+  }
+}
+
+
+/**
+ * Tries every swap on every board at once.  A shape moving into a cell makes
+ * a line if the two cells on either side of it, or the two beyond it in a
+ * line, hold the same shape, not counting the cell it came from.
+ */
+void NoDice::Environment::
+find_dead_boards(std::uint8_t* is_done) const
+{
+  std::fill(is_done, is_done + board_count_, 1);
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      for (int d = 0; d < 2; ++d)
+      {
+        int const dx = 1 - d, dy = d;
+        if (x + dx >= size_ || y + dy >= size_)
+          continue;
+        int const from[2][2] = { { x, y }, { x + dx, y + dy } };
+        for (int i = 0; i < 2; ++i)
+        {
+          int const tx = from[1 - i][0], ty = from[1 - i][1];
+          ShapeId const* moving = lanes(from[i][0], from[i][1]);
+          static const int pairs[6][4] = {
+            { -2, 0, -1, 0 }, { -1, 0, 1, 0 }, { 1, 0, 2, 0 },
+            { 0, -2, 0, -1 }, { 0, -1, 0, 1 }, { 0, 1, 0, 2 },
+          };
+          for (auto const& pair: pairs)
+          {
+            int const x1 = tx + pair[0], y1 = ty + pair[1];
+            int const x2 = tx + pair[2], y2 = ty + pair[3];
+            if (x1 < 0 || x1 >= size_ || y1 < 0 || y1 >= size_
+             || x2 < 0 || x2 >= size_ || y2 < 0 || y2 >= size_
+             || (x1 == from[i][0] && y1 == from[i][1])
+             || (x2 == from[i][0] && y2 == from[i][1]))
+              continue;
+            clear_if_line(board_count_, moving, lanes(x1, y1), lanes(x2, y2),
+                          is_done);
+          }
+        }
+      }
+    }
+  }
+}
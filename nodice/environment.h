@@ -0,0 +1,169 @@
+/**
+ * @file nodice/environment.h
+ * @brief Public interface of the nodice/environment module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_ENVIRONMENT_H
+#define NODICE_ENVIRONMENT_H 1
+
+#include <cstdint>
+#include "nodice/dice.h"
+#include "nodice/random.h"
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * Many games played side by side, for bots that learn by playing.
+   *
+   * The boards play by the same rules as Grid, but they are all kept in one
+   * block: cell c of board b is at c * board_count + b.  Each step of the
+   * rules is a pass over the cells with an inner loop across the boards, so
+   * the same work is done for every board at once and the compiler can spread
+   * the boards over SIMD lanes.  Only making the moves and refilling the holes
+   * are done board by board.
+   *
+   * Each board has its own random numbers, seeded from the environment's seed
+   * plus the board number, and uses them in the same order a Grid would: a
+   * board plays out exactly as a Grid made with the same size, shape count
+   * and seed and driven with generate(), swap(), find_matches(), remove(),
+   * collapse() and refill().
+   *
+   * The reward for a move is the number of dice it clears, with the dice in
+   * each step of the cascade counting one more than those in the step before.
+   * Unlike the game there is no rolling of dice, so the same move on the same
+   * board always gets the same reward.
+   */
+  class Environment
+  {
+  public:
+    /**
+     * A move on one board: the cell number times 2, plus 0 to swap with the
+     * cell to the right or 1 to swap with the cell above.
+     */
+    typedef std::int32_t Action;
+
+    /** The action for making no move. */
+    static const Action no_action = -1;
+
+    enum Direction
+    {
+      move_right = 0,
+      move_up    = 1
+    };
+
+  public:
+    /**
+     * Constructs the boards and starts a game on each.
+     * @param[in] board_count the number of boards
+     * @param[in] size        the number of cells along each side of a board
+     * @param[in] shape_count the number of different shapes (at least 4)
+     * @param[in] seed        the seed for board 0; board b uses seed + b
+     */
+    Environment(int                 board_count,
+                int                 size,
+                int                 shape_count,
+                Random::result_type seed);
+
+    /** Gets the number of boards. */
+    int
+    board_count() const;
+
+    /** Gets the number of cells along each side of a board. */
+    int
+    size() const;
+
+    /** Gets the number of different shapes. */
+    int
+    shape_count() const;
+
+    /** Gets the action for swapping cell (x, y) with its neighbour. */
+    Action
+    action(int x, int y, Direction direction) const;
+
+    /** Gets the shape in a cell of a board. */
+    ShapeId
+    at(int board, int x, int y) const;
+
+    /**
+     * Starts a new game on one board, with no matches and at least one move.
+     * The game uses the next numbers from the board's random numbers.
+     */
+    void
+    reset(int board);
+
+    /**
+     * Makes one move on every board and plays out all the cascades.
+     * @param[in]  actions  one action per board; a move that makes no match is
+     *                      swapped back, and one off the edge is not made
+     * @param[out] rewards  receives the reward for each board
+     * @param[out] is_done  receives 1 for each board left with no move that
+     *                      makes a match, or 0; such a board should be reset
+     */
+    void
+    step(Action const* actions, std::int32_t* rewards, std::uint8_t* is_done);
+
+    /**
+     * Writes the shapes on every board into a buffer, a whole board at a time
+     * in the same cell order as the actions.
+     * @param[out] cells room for board_count() * size() * size() shapes
+     */
+    void
+    observe(ShapeId* cells) const;
+
+  private:
+    ShapeId*
+    lanes(int x, int y);
+
+    ShapeId const*
+    lanes(int x, int y) const;
+
+    void
+    swap(int board, Action action);
+
+    bool
+    mark_matches();
+
+    void
+    remove_marked(int weight, std::int32_t* rewards);
+
+    void
+    collapse();
+
+    void
+    refill();
+
+    void
+    find_dead_boards(std::uint8_t* is_done) const;
+
+  private:
+    int                       board_count_;
+    int                       size_;
+    int                       shape_count_;
+    std::vector<ShapeId>      cells_;
+    std::vector<std::uint8_t> marks_;
+    std::vector<Random>       randoms_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_ENVIRONMENT_H
@@ -20,6 +20,7 @@
 #include "nodice/font.h"
 
 #include <algorithm>
+#include "nodice/glstate.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_GLYPH_H
@@ -231,9 +232,9 @@ mapToTexture()
 	}
 
 	// Send it to the OpenGL engine.
-	glEnable(GL_TEXTURE_2D);
+	glState().enable(GL_TEXTURE_2D);
 	glGenTextures(1, &m_texture);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
+	glState().bind_texture(GL_TEXTURE_2D, m_texture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -243,7 +244,7 @@ mapToTexture()
 	             0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE,
 	             &texture[0]);
 	check_gl_error("glTexImage2D");
-	glDisable(GL_TEXTURE_2D);
+	glState().disable(GL_TEXTURE_2D);
 }
 
 
@@ -272,14 +273,15 @@ print(GLfloat x, GLfloat y, GLfloat scale, const std::string& text)
 	glPushMatrix();
 	glLoadIdentity();
 
-	glDisable(GL_DEPTH_TEST);
-	glBindTexture(GL_TEXTURE_2D, m_texture);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GlState& state = glState();
+	state.disable(GL_DEPTH_TEST);
+	state.bind_texture(GL_TEXTURE_2D, m_texture);
+	state.enable(GL_BLEND);
+	state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable(GL_TEXTURE_2D);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	state.enable(GL_TEXTURE_2D);
+	state.enable_client_state(GL_VERTEX_ARRAY);
+	state.enable_client_state(GL_TEXTURE_COORD_ARRAY);
 
 	static const int coords_per_vertex = 2;
 	static const int coords_per_texture = 2;
@@ -319,11 +321,11 @@ print(GLfloat x, GLfloat y, GLfloat scale, const std::string& text)
 		x += m_glyph[c].advance * scale;
 	}
 
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisable(GL_BLEND);
-	glDisable(GL_TEXTURE_2D);
-	glEnable(GL_DEPTH_TEST);
+	state.disable_client_state(GL_TEXTURE_COORD_ARRAY);
+	state.disable_client_state(GL_VERTEX_ARRAY);
+	state.disable(GL_BLEND);
+	state.disable(GL_TEXTURE_2D);
+	state.enable(GL_DEPTH_TEST);
 
 	glMatrixMode(GL_MODELVIEW);
 	glPopMatrix();
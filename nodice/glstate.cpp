@@ -0,0 +1,210 @@
+/**
+ * @file nodice/glstate.cpp
+ * @brief Implemntation of the nodice/glstate module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/glstate.h"
+
+#include <cstring>
+
+
+namespace
+{
+  /**
+   * Targets for the state that has no GL target of its own.  Real GL enums
+   * are all well above these.
+   */
+  enum Kind : GLenum
+  {
+    kind_capability = 1,
+    kind_client_state,
+    kind_texture,
+    kind_buffer,
+    kind_blend_func,
+    kind_shade_model
+  };
+
+  static const std::size_t colour_size = 4 * sizeof(GLfloat);
+} // anonymous namespace
+
+
+NoDice::GlState::
+GlState()
+: change_count_(0)
+, avoided_count_(0)
+{
+}
+
+
+/**
+ * Looks up a piece of state and records its new value.  The list is short
+ * (a few dozen settings), so a linear search is quicker than anything more
+ * clever.
+ */
+bool NoDice::GlState::
+is_change(GLenum target, GLenum name, void const* value, std::size_t size)
+{
+  for (auto& setting: settings_)
+  {
+    if (setting.target == target && setting.name == name)
+    {
+      if (std::memcmp(setting.value, value, size) == 0)
+      {
+        ++avoided_count_;
+        return false;
+      }
+      std::memcpy(setting.value, value, size);
+      ++change_count_;
+      return true;
+    }
+  }
+
+  Setting setting = { target, name, { 0 } };
+  std::memcpy(setting.value, value, size);
+  settings_.push_back(setting);
+  ++change_count_;
+  return true;
+}
+
+
+void NoDice::GlState::
+enable(GLenum capability)
+{
+  bool const is_on = true;
+  if (is_change(kind_capability, capability, &is_on, sizeof(is_on)))
+    glEnable(capability);
+}
+
+
+void NoDice::GlState::
+disable(GLenum capability)
+{
+  bool const is_on = false;
+  if (is_change(kind_capability, capability, &is_on, sizeof(is_on)))
+    glDisable(capability);
+}
+
+
+void NoDice::GlState::
+enable_client_state(GLenum array)
+{
+  bool const is_on = true;
+  if (is_change(kind_client_state, array, &is_on, sizeof(is_on)))
+    glEnableClientState(array);
+}
+
+
+void NoDice::GlState::
+disable_client_state(GLenum array)
+{
+  bool const is_on = false;
+  if (is_change(kind_client_state, array, &is_on, sizeof(is_on)))
+    glDisableClientState(array);
+}
+
+
+void NoDice::GlState::
+bind_buffer(GLenum target, GLuint buffer)
+{
+  if (is_change(kind_buffer, target, &buffer, sizeof(buffer)))
+    glBindBuffer(target, buffer);
+}
+
+
+void NoDice::GlState::
+bind_texture(GLenum target, GLuint texture)
+{
+  if (is_change(kind_texture, target, &texture, sizeof(texture)))
+    glBindTexture(target, texture);
+}
+
+
+void NoDice::GlState::
+blend_func(GLenum source, GLenum destination)
+{
+  GLenum const factors[] = { source, destination };
+  if (is_change(kind_blend_func, 0, factors, sizeof(factors)))
+    glBlendFunc(source, destination);
+}
+
+
+void NoDice::GlState::
+shade_model(GLenum model)
+{
+  if (is_change(kind_shade_model, 0, &model, sizeof(model)))
+    glShadeModel(model);
+}
+
+
+void NoDice::GlState::
+material(GLenum face, GLenum name, GLfloat const* value)
+{
+  if (is_change(face, name, value, colour_size))
+    glMaterialfv(face, name, value);
+}
+
+
+void NoDice::GlState::
+material(GLenum face, GLenum name, GLfloat value)
+{
+  if (is_change(face, name, &value, sizeof(value)))
+    glMaterialf(face, name, value);
+}
+
+
+void NoDice::GlState::
+light(GLenum light, GLenum name, GLfloat const* value)
+{
+  if (is_change(light, name, value, colour_size))
+    glLightfv(light, name, value);
+}
+
+
+void NoDice::GlState::
+light(GLenum light, GLenum name, GLfloat value)
+{
+  if (is_change(light, name, &value, sizeof(value)))
+    glLightf(light, name, value);
+}
+
+
+void NoDice::GlState::
+forget()
+{
+  settings_.clear();
+}
+
+
+std::size_t NoDice::GlState::
+change_count() const
+{ return change_count_; }
+
+
+std::size_t NoDice::GlState::
+avoided_count() const
+{ return avoided_count_; }
+
+
+NoDice::GlState& NoDice::
+glState()
+{
+  static GlState s_state;
+  return s_state;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file nodice/glstate.h
+ * @brief Public interface of the nodice/glstate module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_GLSTATE_H
+#define NODICE_GLSTATE_H 1
+
+#include "nodice/opengl.h"
+#include <cstddef>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * Keeps track of the GL state that gets switched back and forth every
+   * frame, and skips the calls that would set it to what it already is.
+   *
+   * State calls are cheap on a GPU driver but not on a software renderer,
+   * which may validate the whole pipeline on each one.  Everything that
+   * switches capabilities, client arrays, buffer and texture bindings, the
+   * blend function, the shade model or light and material colours should go
+   * through here so that what is kept stays true.  Anything not yet set
+   * through here is taken to be unknown, so the first call for it is always
+   * made.
+   *
+   * Light positions and directions are left out on purpose: GL transforms
+   * them by the modelview matrix at the time of the call, so the same values
+   * do not always mean the same state.
+   */
+  class GlState
+  {
+  public:
+    /** Constructs a tracker that knows nothing of the GL state yet. */
+    GlState();
+
+    /** Turns a capability on, as glEnable(). */
+    void
+    enable(GLenum capability);
+
+    /** Turns a capability off, as glDisable(). */
+    void
+    disable(GLenum capability);
+
+    /** Turns a client array on, as glEnableClientState(). */
+    void
+    enable_client_state(GLenum array);
+
+    /** Turns a client array off, as glDisableClientState(). */
+    void
+    disable_client_state(GLenum array);
+
+    /** Binds a buffer, as glBindBuffer(). */
+    void
+    bind_buffer(GLenum target, GLuint buffer);
+
+    /** Binds a texture, as glBindTexture(). */
+    void
+    bind_texture(GLenum target, GLuint texture);
+
+    /** Sets the blend function, as glBlendFunc(). */
+    void
+    blend_func(GLenum source, GLenum destination);
+
+    /** Sets the shade model, as glShadeModel(). */
+    void
+    shade_model(GLenum model);
+
+    /** Sets a material colour, as glMaterialfv(). */
+    void
+    material(GLenum face, GLenum name, GLfloat const* value);
+
+    /** Sets a material value, as glMaterialf(). */
+    void
+    material(GLenum face, GLenum name, GLfloat value);
+
+    /**
+     * Sets a light colour, as glLightfv().  Not for GL_POSITION or
+     * GL_SPOT_DIRECTION.
+     */
+    void
+    light(GLenum light, GLenum name, GLfloat const* value);
+
+    /** Sets a light value, as glLightf(). */
+    void
+    light(GLenum light, GLenum name, GLfloat value);
+
+    /**
+     * Forgets all the state, for when it has been changed behind the tracker's
+     * back or the GL context has been made again.
+     */
+    void
+    forget();
+
+    /** Gets the number of state changes passed on to GL. */
+    std::size_t
+    change_count() const;
+
+    /** Gets the number of state changes skipped as already made. */
+    std::size_t
+    avoided_count() const;
+
+  private:
+    /**
+     * One piece of state, known by a target and a name, and the bytes of its
+     * value.  Values are compared byte for byte, so the same bytes mean the
+     * same state whatever the type.
+     */
+    struct Setting
+    {
+      GLenum        target;
+      GLenum        name;
+      unsigned char value[4 * sizeof(GLfloat)];
+    };
+
+    bool
+    is_change(GLenum target, GLenum name, void const* value, std::size_t size);
+
+  private:
+    std::vector<Setting> settings_;
+    std::size_t          change_count_;
+    std::size_t          avoided_count_;
+  };
+
+  /** Gets the tracker of the one GL context. */
+  GlState&
+  glState();
+
+} // namespace NoDice
+
+#endif // NODICE_GLSTATE_H
@@ -0,0 +1,669 @@
+/**
+ * @file nodice/grid.cpp
+ * @brief Implemntation of the nodice/grid module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/grid.h"
+
+#include <algorithm>
+#include <limits>
+#include "nodice/rotate.h"
+#include "nodice/threadpool.h"
+
+
+namespace
+{
+  /** The directions a shape can move in a swap.  d ^ 1 is the opposite of d. */
+  enum MoveDirection
+  {
+    move_right = 0,
+    move_left  = 1,
+    move_up    = 2,
+    move_down  = 3
+  };
+
+  struct Offset
+  {
+    int dx, dy;
+  };
+
+  /**
+   * For a shape that has just moved one step in each direction, the four
+   * pairs of cells around where it landed that make a line of 3 if both hold
+   * the same shape: two straight on, one either side, and two to each side.
+   */
+  static const Offset move_patterns[4][4][2] = {
+    // move_right
+    { { {  1,  0 }, {  2,  0 } },
+      { {  0,  1 }, {  0, -1 } },
+      { {  0,  1 }, {  0,  2 } },
+      { {  0, -1 }, {  0, -2 } } },
+    // move_left
+    { { { -1,  0 }, { -2,  0 } },
+      { {  0,  1 }, {  0, -1 } },
+      { {  0,  1 }, {  0,  2 } },
+      { {  0, -1 }, {  0, -2 } } },
+    // move_up
+    { { {  0,  1 }, {  0,  2 } },
+      { {  1,  0 }, { -1,  0 } },
+      { {  1,  0 }, {  2,  0 } },
+      { { -1,  0 }, { -2,  0 } } },
+    // move_down
+    { { {  0, -1 }, {  0, -2 } },
+      { {  1,  0 }, { -1,  0 } },
+      { {  1,  0 }, {  2,  0 } },
+      { { -1,  0 }, { -2,  0 } } },
+  };
+
+  /** The hash of a grid with every cell empty. */
+  const NoDice::Grid::Hash empty_hash = 0x6a09e667f3bcc909ull;
+
+  /**
+   * Gets the Zobrist key for a shape in a cell.  Rather than keep a table of
+   * random keys for every grid, the keys are made by scrambling the cell and
+   * shape numbers with the splitmix64 finalizer.  An empty cell has no key.
+   */
+  inline NoDice::Grid::Hash
+  zobrist_key(int cell, NoDice::ShapeId shape)
+  {
+    if (shape == NoDice::no_shape)
+      return 0;
+    std::uint64_t z = (std::uint64_t(cell) << 8 | std::uint8_t(shape)) + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+} // anonymous namespace
+
+
+NoDice::Grid::
+Grid(int size, int shape_count, Random::result_type seed)
+: size_(size)
+, shape_count_(shape_count)
+, cells_(size * size, no_shape)
+, bits_(size, shape_count)
+, hash_(empty_hash)
+, random_(seed)
+, refills_(NULL)
+, refill_count_(0)
+, refills_used_(0)
+, pool_(NULL)
+{ }
+
+
+void NoDice::Grid::
+set_thread_pool(ThreadPool* pool)
+{ pool_ = pool; }
+
+
+int NoDice::Grid::
+size() const
+{ return size_; }
+
+
+int NoDice::Grid::
+shape_count() const
+{ return shape_count_; }
+
+
+void NoDice::Grid::
+set_refills(ShapeId const* shapes, std::size_t count)
+{
+  refills_ = shapes;
+  refill_count_ = count;
+  refills_used_ = 0;
+}
+
+
+std::size_t NoDice::Grid::
+refills_used() const
+{ return refills_used_; }
+
+
+NoDice::Random& NoDice::Grid::
+random()
+{ return random_; }
+
+
+NoDice::ShapeId NoDice::Grid::
+at(int x, int y) const
+{ return cells_[x + y * size_]; }
+
+
+NoDice::Grid::Hash NoDice::Grid::
+hash() const
+{ return hash_; }
+
+
+void NoDice::Grid::
+set(int x, int y, ShapeId shape)
+{
+  put(x, y, shape, hash_);
+}
+
+
+void NoDice::Grid::
+fill()
+{
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      set(x, y, random_.below(shape_count_));
+    }
+  }
+}
+
+
+/**
+ * First an almost-line is planted somewhere at random: two of a shape side by
+ * side and a third diagonally beyond them, one row up, so that moving the
+ * third one down makes a line.
+ *
+ *     . . A
+ *     A A .
+ *
+ * Then the rest of the cells are filled in row by row, each one avoiding any
+ * shape that would make a line with the cells already filled.  Away from the
+ * planted cells only the two cells to the left and the two below are ever
+ * filled, so that is all that gets checked.  At most 3 shapes ever need to be
+ * avoided for one cell, so with 4 or more shapes there is always a choice.
+ */
+void NoDice::Grid::
+generate()
+{
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+      set(x, y, no_shape);
+  }
+
+  if (size_ >= 3 && shape_count_ >= 4)
+  {
+    int const x = random_.below(size_ - 2);
+    int const y = random_.below(size_ - 1);
+    ShapeId const shape = random_.below(shape_count_);
+    set(x, y, shape);
+    set(x + 1, y, shape);
+    set(x + 2, y + 1, shape);
+  }
+
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      if (at(x, y) == no_shape)
+        set(x, y, choose_shape_without_line(x, y));
+    }
+  }
+}
+
+
+void NoDice::Grid::
+swap(const Vector2i& p1, const Vector2i& p2)
+{
+  ShapeId const shape = at(p1.x, p1.y);
+  set(p1.x, p1.y, at(p2.x, p2.y));
+  set(p2.x, p2.y, shape);
+}
+
+
+void NoDice::Grid::
+find_matches(RunList& runs)
+{
+  bits_.find_dirty_runs(runs);
+}
+
+
+void NoDice::Grid::
+remove(RunList const& runs)
+{
+  for (auto const& run: runs)
+  {
+    for (int i = 0; i < run.length; ++i)
+    {
+      set(run.x + i * run.dx, run.y + i * run.dy, no_shape);
+    }
+  }
+}
+
+
+/**
+ * Columns fall independently, so with a thread pool each strip of columns
+ * that shares bitboard words is collapsed on its own thread into its own
+ * lists.  Joining the lists in strip order gives exactly what doing the
+ * columns one after another would.  Each strip also keeps its own change to
+ * the hash, and since the changes are XORed in the order does not matter.
+ */
+void NoDice::Grid::
+collapse(FallList& falls, CellList& empties)
+{
+  falls.clear();
+  empties.clear();
+  int const strips = strip_count();
+  if (!pool_ || strips < 2)
+  {
+    for (int strip = 0; strip < strips; ++strip)
+      collapse_strip(strip, falls, empties, hash_);
+    return;
+  }
+
+  strip_falls_.resize(strips);
+  strip_empties_.resize(strips);
+  strip_hashes_.resize(strips);
+  pool_->parallel_for(strips, [this](int strip)
+  {
+    strip_falls_[strip].clear();
+    strip_empties_[strip].clear();
+    strip_hashes_[strip] = 0;
+    collapse_strip(strip, strip_falls_[strip], strip_empties_[strip],
+                   strip_hashes_[strip]);
+  });
+  for (int strip = 0; strip < strips; ++strip)
+  {
+    hash_ ^= strip_hashes_[strip];
+    falls.insert(falls.end(), strip_falls_[strip].begin(), strip_falls_[strip].end());
+    empties.insert(empties.end(), strip_empties_[strip].begin(), strip_empties_[strip].end());
+  }
+}
+
+
+/**
+ * The new shapes are always chosen one after another so the random numbers
+ * are used up in the same order with or without a thread pool.  Only putting
+ * them in the cells is shared out, a strip of columns to each thread.
+ */
+void NoDice::Grid::
+refill(CellList const& cells)
+{
+  int const strips = strip_count();
+  if (!pool_ || strips < 2)
+  {
+    for (auto const& cell: cells)
+    {
+      set(cell.x, cell.y, choose_shape());
+    }
+    return;
+  }
+
+  fresh_shapes_.resize(cells.size());
+  for (auto& shape: fresh_shapes_)
+  {
+    shape = choose_shape();
+  }
+  strip_hashes_.resize(strips);
+  pool_->parallel_for(strips, [this, &cells](int strip)
+  {
+    strip_hashes_[strip] = 0;
+    for (CellList::size_type i = 0; i < cells.size(); ++i)
+    {
+      if (cells[i].x / BitBoard::columns_per_word == strip)
+        put(cells[i].x, cells[i].y, fresh_shapes_[i], strip_hashes_[strip]);
+    }
+  });
+  for (int strip = 0; strip < strips; ++strip)
+  {
+    hash_ ^= strip_hashes_[strip];
+  }
+}
+
+
+/**
+ * The shapes are counted up and the grid is emptied.  Then, as in generate(),
+ * an almost-line of the most common shape is planted somewhere at random and
+ * the rest of the cells are filled in row by row, each drawing one of the
+ * shapes left over that makes no line there.  Near the end the only shapes
+ * left may all make a line in a cell, and then one of them is swapped in for
+ * a shape already laid out that fits the cell instead.  If there is no such
+ * shape either, the grid is put back from a copy.
+ */
+bool NoDice::Grid::
+rearrange()
+{
+  std::vector<int> counts(shape_count_, 0);
+  for (ShapeId const shape: cells_)
+  {
+    if (shape != no_shape)
+      ++counts[shape];
+  }
+  ShapeId const common = ShapeId(std::max_element(counts.begin(), counts.end())
+                                 - counts.begin());
+  if (size_ < 3 || counts[common] < 3)
+    return false;
+
+  std::vector<ShapeId> const before(cells_);
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+      set(x, y, no_shape);
+  }
+
+  std::vector<bool> is_planted(cells_.size(), false);
+  {
+    int const x = random_.below(size_ - 2);
+    int const y = random_.below(size_ - 1);
+    for (Vector2i const& p: { Vector2i(x, y), Vector2i(x + 1, y), Vector2i(x + 2, y + 1) })
+    {
+      set(p.x, p.y, common);
+      is_planted[p.x + p.y * size_] = true;
+    }
+    counts[common] -= 3;
+  }
+
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      if (at(x, y) != no_shape)
+        continue;
+      ShapeId const shape = draw_shape_without_line(x, y, counts);
+      if (shape != no_shape)
+        set(x, y, shape);
+      else if (!swap_in_shape(x, y, counts, is_planted))
+      {
+        for (std::size_t cell = 0; cell < before.size(); ++cell)
+          set(int(cell) % size_, int(cell) / size_, before[cell]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+/**
+ * The cells are turned into a spare array and put back one at a time, which
+ * keeps the bitboard and the hash up to date.  The turned grid holds the same
+ * lines as before, so it has no new matches.
+ */
+void NoDice::Grid::
+rotate()
+{
+  std::vector<ShapeId> turned(cells_.size());
+  rotate_clockwise(cells_.data(), turned.data(), size_);
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+      set(x, y, turned[x + y * size_]);
+  }
+}
+
+
+/**
+ * Each cell is checked moving into the other's place.  Swapping two of the
+ * same shape changes nothing, so it can never make a match.
+ */
+bool NoDice::Grid::
+is_winning_swap(const Vector2i& p1, const Vector2i& p2) const
+{
+  ShapeId const s1 = at(p1.x, p1.y);
+  ShapeId const s2 = at(p2.x, p2.y);
+  if (s1 == s2 || s1 == no_shape || s2 == no_shape)
+    return false;
+
+  int const direction = (p2.x > p1.x) ? move_right
+                      : (p2.x < p1.x) ? move_left
+                      : (p2.y > p1.y) ? move_up
+                      :                 move_down;
+  return completes_line(s1, p2.x, p2.y, direction)
+      || completes_line(s2, p1.x, p1.y, direction ^ 1);
+}
+
+
+void NoDice::Grid::
+find_winning_swaps(MoveList& moves) const
+{
+  moves.clear();
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      const Vector2i p(x, y);
+      if (x + 1 < size_ && is_winning_swap(p, Vector2i(x + 1, y)))
+        moves.push_back(std::make_pair(p, Vector2i(x + 1, y)));
+      if (y + 1 < size_ && is_winning_swap(p, Vector2i(x, y + 1)))
+        moves.push_back(std::make_pair(p, Vector2i(x, y + 1)));
+    }
+  }
+}
+
+
+bool NoDice::Grid::
+has_winning_swap() const
+{
+  for (int y = 0; y < size_; ++y)
+  {
+    for (int x = 0; x < size_; ++x)
+    {
+      if (x + 1 < size_ && is_winning_swap(Vector2i(x, y), Vector2i(x + 1, y)))
+        return true;
+      if (y + 1 < size_ && is_winning_swap(Vector2i(x, y), Vector2i(x, y + 1)))
+        return true;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Chooses the shape for a cell left empty by a collapse: the next one from the
+ * refill list if there is one, or else one at random.
+ */
+NoDice::ShapeId NoDice::Grid::
+choose_shape()
+{
+  if (refills_)
+    return refills_used_ < refill_count_ ? refills_[refills_used_++] : no_shape;
+  return random_.below(shape_count_);
+}
+
+
+/**
+ * Puts a shape in a cell and XORs the change to the cell's key into @p hash,
+ * which is the grid's own hash unless a strip is keeping its changes apart.
+ */
+void NoDice::Grid::
+put(int x, int y, ShapeId shape, Hash& hash)
+{
+  int const cell = x + y * size_;
+  hash ^= zobrist_key(cell, cells_[cell]) ^ zobrist_key(cell, shape);
+  cells_[cell] = shape;
+  bits_.set(x, y, shape);
+}
+
+
+/**
+ * Picks evenly among the shapes that do not make a line at (x, y).  If every
+ * shape would, which can only happen with fewer than 3 shapes, any will do.
+ */
+NoDice::ShapeId NoDice::Grid::
+choose_shape_without_line(int x, int y)
+{
+  bool is_banned[std::numeric_limits<ShapeId>::max() + 1];
+  int banned_count = 0;
+  for (ShapeId shape = 0; shape < shape_count_; ++shape)
+  {
+    is_banned[shape] = makes_line(shape, x, y);
+    banned_count += is_banned[shape];
+  }
+  if (banned_count == shape_count_)
+    return random_.below(shape_count_);
+
+  int choice = random_.below(shape_count_ - banned_count);
+  ShapeId shape = 0;
+  for (;; ++shape)
+  {
+    if (!is_banned[shape] && choice-- == 0)
+      break;
+  }
+  return shape;
+}
+
+
+/**
+ * Indicates if putting @p shape at (x, y) would make a line of 3 with cells
+ * that are already filled.
+ */
+bool NoDice::Grid::
+makes_line(ShapeId shape, int x, int y) const
+{
+  auto const is = [this, shape](int x, int y)
+  {
+    return x >= 0 && x < size_ && y >= 0 && y < size_ && at(x, y) == shape;
+  };
+  return (is(x - 2, y) && is(x - 1, y))
+      || (is(x - 1, y) && is(x + 1, y))
+      || (is(x + 1, y) && is(x + 2, y))
+      || (is(x, y - 2) && is(x, y - 1))
+      || (is(x, y - 1) && is(x, y + 1))
+      || (is(x, y + 1) && is(x, y + 2));
+}
+
+
+/**
+ * The columns are split into strips that each fill whole bitboard words, so
+ * no two strips ever write the same word.
+ */
+int NoDice::Grid::
+strip_count() const
+{
+  return (size_ + BitBoard::columns_per_word - 1) / BitBoard::columns_per_word;
+}
+
+
+void NoDice::Grid::
+collapse_strip(int strip, FallList& falls, CellList& empties, Hash& hash)
+{
+  int const x_end = std::min(size_, (strip + 1) * BitBoard::columns_per_word);
+  for (int x = strip * BitBoard::columns_per_word; x < x_end; ++x)
+  {
+    int drop = 0;
+    for (int y = 0; y < size_; ++y)
+    {
+      ShapeId const shape = at(x, y);
+      if (shape == no_shape)
+      {
+        ++drop;
+      }
+      else if (drop > 0)
+      {
+        put(x, y - drop, shape, hash);
+        put(x, y, no_shape, hash);
+        falls.push_back(Fall{ x, y, y - drop });
+      }
+    }
+    for (int y = 0; y < drop; ++y)
+    {
+      empties.push_back(Vector2i(x, size_ - y - 1));
+    }
+  }
+}
+
+
+/**
+ * Checks the move patterns for a shape landing on (x, y) having moved one
+ * step in @p direction.  The cell it came from is never part of a pattern.
+ */
+bool NoDice::Grid::
+completes_line(ShapeId shape, int x, int y, int direction) const
+{
+  for (auto const& pattern: move_patterns[direction])
+  {
+    int const x1 = x + pattern[0].dx, y1 = y + pattern[0].dy;
+    int const x2 = x + pattern[1].dx, y2 = y + pattern[1].dy;
+    if (x1 >= 0 && x1 < size_ && y1 >= 0 && y1 < size_
+        && x2 >= 0 && x2 < size_ && y2 >= 0 && y2 < size_
+        && at(x1, y1) == shape && at(x2, y2) == shape)
+      return true;
+  }
+  return false;
+}
+
+
+/**
+ * Draws one of the shapes left over at random, as if from a bag, passing over
+ * any that would make a line at (x, y).
+ * @returns the shape drawn, or no_shape if every one left makes a line
+ */
+NoDice::ShapeId NoDice::Grid::
+draw_shape_without_line(int x, int y, std::vector<int>& counts)
+{
+  int total = 0;
+  for (ShapeId shape = 0; shape < shape_count_; ++shape)
+  {
+    if (counts[shape] > 0 && !makes_line(shape, x, y))
+      total += counts[shape];
+  }
+  if (total == 0)
+    return no_shape;
+
+  int choice = random_.below(total);
+  ShapeId shape = 0;
+  for (;; ++shape)
+  {
+    if (counts[shape] > 0 && !makes_line(shape, x, y))
+    {
+      choice -= counts[shape];
+      if (choice < 0)
+        break;
+    }
+  }
+  --counts[shape];
+  return shape;
+}
+
+
+/**
+ * Fills (x, y) when every shape left over would make a line there, by moving
+ * a shape already laid out that fits (x, y) and putting a shape left over in
+ * its place instead.  The planted cells are left alone so the winning swap
+ * stays.
+ * @returns false, leaving the grid as it was, if no such shape is found
+ */
+bool NoDice::Grid::
+swap_in_shape(int x, int y, std::vector<int>& counts, std::vector<bool> const& is_planted)
+{
+  int const end = x + y * size_;
+  for (int cell = 0; cell < end; ++cell)
+  {
+    if (is_planted[cell])
+      continue;
+    int const cx = cell % size_;
+    int const cy = cell / size_;
+    ShapeId const moved = cells_[cell];
+    set(cx, cy, no_shape);
+    if (!makes_line(moved, x, y))
+    {
+      set(x, y, moved);
+      for (ShapeId shape = 0; shape < shape_count_; ++shape)
+      {
+        if (counts[shape] > 0 && !makes_line(shape, cx, cy))
+        {
+          set(cx, cy, shape);
+          --counts[shape];
+          return true;
+        }
+      }
+      set(x, y, no_shape);
+    }
+    set(cx, cy, moved);
+  }
+  return false;
+}
@@ -0,0 +1,264 @@
+/**
+ * @file nodice/grid.h
+ * @brief Public interface of the nodice/grid module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_GRID_H
+#define NODICE_GRID_H 1
+
+#include "nodice/bitboard.h"
+#include "nodice/dice.h"
+#include "nodice/maths.h"
+#include "nodice/random.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace NoDice
+{
+  class ThreadPool;
+
+  /**
+   * The rules of the game, without any of the pretty pictures.
+   *
+   * A grid is a square of cells each holding the ID of a shape.  It knows how
+   * to swap cells, find and remove matches, let the cells above a hole fall
+   * into it, and refill the holes left at the top.  It has no idea about
+   * drawing or animation, so it can be used with no video context at all.
+   *
+   * Cell (0, 0) is at the bottom left and things fall towards y = 0.
+   *
+   * The grid keeps a Zobrist hash of its cells up to date as they change, so
+   * positions that have been seen before can be spotted cheaply.
+   */
+  class Grid
+  {
+  public:
+    typedef BitBoard::Run                 Run;
+    typedef BitBoard::RunList             RunList;
+    typedef std::pair<Vector2i, Vector2i> Move;
+    typedef std::vector<Move>             MoveList;
+    typedef std::vector<Vector2i>         CellList;
+    typedef std::uint64_t                 Hash;
+
+    /** A shape falling down column x from row from_y to row to_y. */
+    struct Fall
+    {
+      int x;
+      int from_y;
+      int to_y;
+    };
+
+    typedef std::vector<Fall>             FallList;
+
+  public:
+    /**
+     * Constructs an empty grid.
+     * @param[in] size        the number of cells along each side
+     * @param[in] shape_count the number of different shapes to choose from
+     * @param[in] seed        the seed for the grid's random numbers
+     */
+    Grid(int size, int shape_count, Random::result_type seed);
+
+    /** Gets the number of cells along each side of the grid. */
+    int
+    size() const;
+
+    /** Gets the number of different shapes. */
+    int
+    shape_count() const;
+
+    /**
+     * Lets the grid spread the work of collapsing and refilling over a pool
+     * of threads.  The grid does not own the pool, and gives the same results
+     * with or without one.
+     */
+    void
+    set_thread_pool(ThreadPool* pool);
+
+    /**
+     * Makes the grid draw the shapes it puts in empty cells from a fixed list
+     * instead of at random, for puzzles.  The shapes are used in order, and
+     * once they run out the empty cells are left empty.  The grid does not own
+     * the list, which must outlive the grid and its copies.
+     * @param[in] shapes the shapes to draw, or NULL to go back to random ones
+     * @param[in] count  the number of shapes in the list
+     */
+    void
+    set_refills(ShapeId const* shapes, std::size_t count);
+
+    /** Gets the number of shapes drawn from the refill list so far. */
+    std::size_t
+    refills_used() const;
+
+    /** Gets the grid's source of random numbers. */
+    Random&
+    random();
+
+    /** Gets the shape in a cell. */
+    ShapeId
+    at(int x, int y) const;
+
+    /**
+     * Gets the Zobrist hash of the shapes in the cells.  Grids of the same size
+     * holding the same shapes in the same cells have the same hash, however
+     * they got that way.
+     */
+    Hash
+    hash() const;
+
+    /** Puts a shape in a cell. */
+    void
+    set(int x, int y, ShapeId shape);
+
+    /** Fills every cell with a randomly-chosen shape. */
+    void
+    fill();
+
+    /**
+     * Fills every cell with a randomly-chosen shape so that there is no match
+     * on the grid and, given at least 4 shapes, at least one winning swap.
+     * It takes one pass over the grid and never has to start again.
+     */
+    void
+    generate();
+
+    /** Exchanges the contents of two cells. */
+    void
+    swap(const Vector2i& p1, const Vector2i& p2);
+
+    /**
+     * Finds the runs of 3 or more matching shapes created since the last call.
+     * @param[out] runs  receives the horizontal runs in row order followed by
+     *                   the vertical runs in column order
+     */
+    void
+    find_matches(RunList& runs);
+
+    /** Empties every cell in a list of runs. */
+    void
+    remove(RunList const& runs);
+
+    /**
+     * Lets shapes fall into the empty cells below them.
+     * @param[out] falls   receives every shape that fell, column by column
+     *                     from the bottom up
+     * @param[out] empties receives the cells left empty at the top of each
+     *                     column, column by column from the top down
+     */
+    void
+    collapse(FallList& falls, CellList& empties);
+
+    /** Puts a randomly-chosen shape in each of a list of cells. */
+    void
+    refill(CellList const& cells);
+
+    /**
+     * Lays the shapes on the grid out again in a new order so that, like
+     * generate(), there is no match and at least one winning swap.  It takes
+     * one pass over the grid and never has to start again.
+     * @returns false, leaving the grid as it was, if there are too few of any
+     *          shape to plant a move or so many of one shape that they will
+     *          not fit without a line
+     */
+    bool
+    rearrange();
+
+    /**
+     * Turns the whole grid a quarter turn clockwise, so the shape at (x, y)
+     * ends up at (y, size - 1 - x).  Shapes still fall towards y = 0, so what
+     * was the left-hand side of the grid becomes the bottom.
+     */
+    void
+    rotate();
+
+    /**
+     * Indicates if swapping two neighbouring cells would make a match.  The
+     * grid is expected to have no matches on it already.  Swapping with an
+     * empty cell never makes a match.
+     */
+    bool
+    is_winning_swap(const Vector2i& p1, const Vector2i& p2) const;
+
+    /**
+     * Finds every swap of neighbouring cells that would make a match.
+     * @param[out] moves receives the pairs of cells to swap, in row order,
+     *                   each as (cell, cell to its right or above)
+     *
+     * This takes time in proportion to the number of cells and does not
+     * allocate once @p moves has grown big enough.
+     */
+    void
+    find_winning_swaps(MoveList& moves) const;
+
+    /** Indicates if there is any swap that would make a match. */
+    bool
+    has_winning_swap() const;
+
+  private:
+    ShapeId
+    choose_shape();
+
+    void
+    put(int x, int y, ShapeId shape, Hash& hash);
+
+    ShapeId
+    choose_shape_without_line(int x, int y);
+
+    bool
+    makes_line(ShapeId shape, int x, int y) const;
+
+    ShapeId
+    draw_shape_without_line(int x, int y, std::vector<int>& counts);
+
+    bool
+    swap_in_shape(int x, int y, std::vector<int>& counts,
+                  std::vector<bool> const& is_planted);
+
+    int
+    strip_count() const;
+
+    void
+    collapse_strip(int strip, FallList& falls, CellList& empties, Hash& hash);
+
+    bool
+    completes_line(ShapeId shape, int x, int y, int direction) const;
+
+  private:
+    int                   size_;
+    int                   shape_count_;
+    std::vector<ShapeId>  cells_;
+    BitBoard              bits_;
+    Hash                  hash_;
+    Random                random_;
+    ShapeId const*        refills_;
+    std::size_t           refill_count_;
+    std::size_t           refills_used_;
+    ThreadPool*           pool_;
+    std::vector<FallList> strip_falls_;
+    std::vector<CellList> strip_empties_;
+    std::vector<ShapeId>  fresh_shapes_;
+    std::vector<Hash>     strip_hashes_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_GRID_H
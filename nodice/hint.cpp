@@ -0,0 +1,240 @@
+/**
+ * @file nodice/hint.cpp
+ * @brief Implemntation of the nodice/hint module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/hint.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "nodice/cascade.h"
+
+
+namespace
+{
+  /** The number of positions the engine remembers the rollouts for. */
+  const std::size_t table_size = 1 << 16;
+
+  /** Packs a rollout count and mean score into a table value. */
+  NoDice::TranspositionTable::Value
+  pack(int rollout_count, double mean_score)
+  {
+    float const mean = float(mean_score);
+    std::uint32_t bits;
+    std::memcpy(&bits, &mean, sizeof(bits));
+    return NoDice::TranspositionTable::Value(rollout_count) << 32 | bits;
+  }
+
+  /** Unpacks a table value into a rollout count and mean score. */
+  void
+  unpack(NoDice::TranspositionTable::Value value, NoDice::Hint& hint)
+  {
+    std::uint32_t const bits = std::uint32_t(value);
+    float mean;
+    std::memcpy(&mean, &bits, sizeof(mean));
+    hint.mean_score = mean;
+    hint.rollout_count = int(value >> 32);
+  }
+} // anonymous namespace
+
+
+/**
+ * Everything about one request, shared by the engine and the tasks working
+ * on it so that it lives until the last of them lets go.
+ */
+struct NoDice::HintEngine::Request
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Request(Grid const& grid, TranspositionTable& table,
+          Clock::time_point deadline, int max_rollouts,
+          Random::result_type seed)
+  : grid(grid)
+  , table(table)
+  , deadline(deadline)
+  , max_rollouts(max_rollouts)
+  , seed(seed)
+  , is_cancelled(false)
+  , is_done(false)
+  , is_found(false)
+  {
+    this->grid.set_thread_pool(nullptr);
+    this->grid.find_winning_swaps(moves);
+    results.resize(moves.size());
+    remaining = int(moves.size());
+  }
+
+  Grid                grid;
+  Grid::MoveList      moves;
+  std::vector<Hint>   results;
+  TranspositionTable& table;
+  Clock::time_point   deadline;
+  int                 max_rollouts;
+  Random::result_type seed;
+  std::atomic<int>    remaining;
+  std::atomic<bool>   is_cancelled;
+  std::atomic<bool>   is_done;
+  bool                is_found;  ///< set before is_done
+  Hint                best;      ///< set before is_done
+};
+
+
+NoDice::HintEngine::
+HintEngine(Random::result_type seed, int max_rollouts, unsigned thread_count)
+: max_rollouts_(max_rollouts)
+, random_(seed)
+, table_(table_size)
+, pool_(thread_count)
+{
+}
+
+
+NoDice::HintEngine::
+~HintEngine()
+{
+  cancel();
+}
+
+
+void NoDice::HintEngine::
+request(Grid const& grid, Budget budget)
+{
+  cancel();
+  request_ = std::make_shared<Request>(grid,
+                                       table_,
+                                       Request::Clock::now() + budget,
+                                       max_rollouts_,
+                                       random_());
+  if (request_->moves.empty())
+  {
+    request_->is_done = true;
+    return;
+  }
+
+  std::shared_ptr<Request> const& request = request_;
+  for (int i = 0; i < int(request->moves.size()); ++i)
+  {
+    pool_.submit([request, i] { play_out(request, i); });
+  }
+}
+
+
+void NoDice::HintEngine::
+cancel()
+{
+  if (request_)
+  {
+    request_->is_cancelled = true;
+    request_.reset();
+  }
+}
+
+
+bool NoDice::HintEngine::
+is_busy() const
+{
+  return request_ && !request_->is_done;
+}
+
+
+bool NoDice::HintEngine::
+poll(Hint& hint)
+{
+  if (!request_ || !request_->is_done)
+    return false;
+
+  bool const is_found = request_->is_found;
+  if (is_found)
+    hint = request_->best;
+  request_.reset();
+  return is_found;
+}
+
+
+/**
+ * Plays out one swap over and over until it has had its rollouts, the time
+ * runs out, or the request is cancelled.  Whichever task finishes last picks
+ * the best swap.
+ *
+ * Only a swap that got its full count of rollouts goes in the table, so a
+ * rushed request never stands in for a proper one later on.
+ */
+void NoDice::HintEngine::
+play_out(std::shared_ptr<Request> const& request, int move)
+{
+  Grid::Move const& swap = request->moves[move];
+  Hint& hint = request->results[move];
+  hint.move = swap;
+
+  Grid trial(request->grid);
+  trial.swap(swap.first, swap.second);
+  Grid::Hash const position = trial.hash();
+  TranspositionTable::Value value;
+  if (request->table.find(position, value))
+  {
+    unpack(value, hint);
+    if (hint.rollout_count >= request->max_rollouts)
+    {
+      finish(request);
+      return;
+    }
+  }
+
+  MoveResult result;
+  Random seeds(request->seed + move);
+  std::int64_t total = 0;
+  int count = 0;
+  while (count < request->max_rollouts && !request->is_cancelled)
+  {
+    if (count > 0 && Request::Clock::now() >= request->deadline)
+      break;
+    trial = request->grid;
+    trial.random().seed(seeds());
+    resolve_move(trial, swap.first, swap.second, result);
+    total += result.score;
+    ++count;
+  }
+  hint.mean_score = count ? double(total) / count : 0.0;
+  hint.rollout_count = count;
+  if (count == request->max_rollouts)
+    request->table.store(position, pack(count, hint.mean_score));
+  finish(request);
+}
+
+
+void NoDice::HintEngine::
+finish(std::shared_ptr<Request> const& request)
+{
+  if (request->remaining.fetch_sub(1) != 1)
+    return;
+  if (!request->is_cancelled)
+  {
+    Hint const* best = &request->results[0];
+    for (auto const& hint: request->results)
+    {
+      if (hint.mean_score > best->mean_score)
+        best = &hint;
+    }
+    request->best = *best;
+    request->is_found = true;
+  }
+  request->is_done = true;
+}
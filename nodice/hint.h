@@ -0,0 +1,133 @@
+/**
+ * @file nodice/hint.h
+ * @brief Public interface of the nodice/hint module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_HINT_H
+#define NODICE_HINT_H 1
+
+#include "nodice/grid.h"
+#include "nodice/random.h"
+#include "nodice/threadpool.h"
+#include "nodice/transposition.h"
+#include <chrono>
+#include <memory>
+
+
+namespace NoDice
+{
+
+  /** A suggested move and how well it did. */
+  struct Hint
+  {
+    Grid::Move move;
+    double     mean_score;     ///< the average score of the rollouts
+    int        rollout_count;  ///< the number of rollouts played out
+  };
+
+  /**
+   * Works out the best move on a grid without holding up the caller.
+   *
+   * Each winning swap is tried many times on a copy of the grid, each time
+   * with a different stream of random numbers so the cascade refills and the
+   * dice rolls come out differently, and the swap with the best average score
+   * wins.  The swaps are played out on the engine's own threads.
+   *
+   * Only one request is worked on at a time: a new request or a call to
+   * cancel() drops the one before, and any work already queued for it stops
+   * after its current rollout.
+   *
+   * The position each swap leads to is looked up by its hash in a table kept
+   * from one request to the next, and a swap leading to a position that has
+   * already had its full count of rollouts is not played out again.  That
+   * catches a grid that comes back after an un-swap, and two swaps that come
+   * to the same thing.
+   */
+  class HintEngine
+  {
+  public:
+    typedef std::chrono::milliseconds Budget;
+
+  public:
+    /**
+     * Starts the engine's threads.
+     * @param[in] seed         the seed for the rollouts' random numbers
+     * @param[in] max_rollouts the most rollouts to play out for each swap
+     * @param[in] thread_count the number of threads, or 0 for one per core
+     */
+    HintEngine(Random::result_type seed,
+               int                 max_rollouts = 200,
+               unsigned            thread_count = 0);
+
+    /** Cancels any request and stops the threads. */
+    ~HintEngine();
+
+    /**
+     * Starts working out the best move on a grid, dropping any earlier
+     * request.  The grid is copied so it may change straight away.
+     * @param[in] grid   a grid with no matches on it
+     * @param[in] budget how long to spend before settling for the rollouts
+     *                   played out so far
+     *
+     * Each swap gets at least one rollout however short the budget.
+     */
+    void
+    request(Grid const& grid, Budget budget);
+
+    /** Drops the current request, if any. */
+    void
+    cancel();
+
+    /** Indicates if a request is still being worked on. */
+    bool
+    is_busy() const;
+
+    /**
+     * Collects the result of the current request if it is finished.
+     * @param[out] hint receives the best move
+     * @returns true if there was a best move, false if the request is not
+     *          finished yet, was cancelled, or the grid had no winning swap
+     */
+    bool
+    poll(Hint& hint);
+
+  private:
+    struct Request;
+
+    HintEngine(HintEngine const&) = delete;
+    HintEngine& operator=(HintEngine const&) = delete;
+
+    static void
+    play_out(std::shared_ptr<Request> const& request, int move);
+
+    static void
+    finish(std::shared_ptr<Request> const& request);
+
+  private:
+    int                      max_rollouts_;
+    Random                   random_;
+    TranspositionTable       table_;
+    std::shared_ptr<Request> request_;
+    ThreadPool               pool_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_HINT_H
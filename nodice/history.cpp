@@ -0,0 +1,596 @@
+/**
+ * @file nodice/history.cpp
+ * @brief Implemntation of the nodice/history module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/history.h"
+
+#include <algorithm>
+
+
+namespace
+{
+  /**
+   * The kinds of record a turn is made of, each a kind byte followed by:
+   *
+   * swap:      the two cells swapped
+   * step:      the number of matches, and for each its shape, its size, and
+   *            its cells in order as gaps from the one before; then the rolls
+   *            of each match, the bonus, and the refilled shapes two to a byte
+   * wide step: a step on a grid with too many shapes for half a byte, with
+   *            each refilled shape in a byte of its own
+   * rearrange: the number of cells changed, and for each the gap from the one
+   *            before and its old and new shape
+   *
+   * The rolls of a match are kept two to a byte if they are all under 16,
+   * which is marked by setting the top bit of the match's shape.  Numbers are
+   * kept 7 bits to a byte, low bits first, with the top bit set on every byte
+   * but the last.
+   */
+  enum RecordKind
+  {
+    record_swap      = 's',
+    record_step      = 'c',
+    record_wide_step = 'C',
+    record_rearrange = 'r'
+  };
+
+  /** The bit set in a match's shape when its rolls are two to a byte. */
+  static const unsigned small_rolls = 0x80;
+
+  /** The half-byte kept for an empty cell among the refills. */
+  static const unsigned no_refill = 0xf;
+
+  /** The byte kept for an empty cell among the refills of a wide step. */
+  static const unsigned no_wide_refill = 0xff;
+
+  /**
+   * The history grows by an eighth at a time rather than doubling, so a long
+   * one does not carry megabytes of room it may never use.
+   */
+  static const std::size_t min_growth = 64 * 1024;
+
+  inline int
+  cell_index(NoDice::Grid const& grid, NoDice::Vector2i const& p)
+  { return p.x + p.y * grid.size(); }
+
+  inline NoDice::Vector2i
+  cell_at(NoDice::Grid const& grid, int cell)
+  { return NoDice::Vector2i(cell % grid.size(), cell / grid.size()); }
+
+  inline unsigned
+  refill_code(NoDice::ShapeId shape, unsigned none)
+  { return shape == NoDice::no_shape ? none : unsigned(shape); }
+
+  /** Whether every shape on a grid, and an empty cell, fit in half a byte. */
+  inline bool
+  has_small_refills(NoDice::Grid const& grid)
+  { return grid.shape_count() < int(no_refill); }
+
+  inline bool
+  is_step(NoDice::History::Byte kind)
+  { return kind == record_step || kind == record_wide_step; }
+} // anonymous namespace
+
+
+NoDice::History::
+History()
+: done_count_(0)
+, is_recording_(false)
+{ }
+
+
+std::size_t NoDice::History::
+undo_count() const
+{ return done_count_; }
+
+
+std::size_t NoDice::History::
+redo_count() const
+{ return turns_.size() - done_count_; }
+
+
+std::size_t NoDice::History::
+byte_count() const
+{ return bytes_.capacity() + turns_.capacity() * sizeof(std::size_t); }
+
+
+void NoDice::History::
+clear()
+{
+  bytes_.clear();
+  turns_.clear();
+  done_count_ = 0;
+  is_recording_ = false;
+}
+
+
+void NoDice::History::
+begin_turn()
+{
+  if (done_count_ < turns_.size())
+  {
+    bytes_.resize(turns_[done_count_]);
+    turns_.resize(done_count_);
+  }
+  turns_.push_back(bytes_.size());
+  ++done_count_;
+
+  if (bytes_.capacity() - bytes_.size() < min_growth / 2)
+    bytes_.reserve(bytes_.size() + bytes_.size() / 8 + min_growth);
+}
+
+
+void NoDice::History::
+put(unsigned value)
+{
+  while (value >= 0x80)
+  {
+    bytes_.push_back(Byte(value | 0x80));
+    value >>= 7;
+  }
+  bytes_.push_back(Byte(value));
+}
+
+
+unsigned NoDice::History::
+get(std::size_t& at) const
+{
+  unsigned value = 0;
+  for (int shift = 0; ; shift += 7)
+  {
+    Byte const b = bytes_[at++];
+    value |= unsigned(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return value;
+  }
+}
+
+
+void NoDice::History::
+begin_move(Grid const& grid, Grid::Move const& swap)
+{
+  begin_turn();
+  is_recording_ = true;
+  bytes_.push_back(record_swap);
+  put(cell_index(grid, swap.first));
+  put(cell_index(grid, swap.second));
+}
+
+
+void NoDice::History::
+end_move()
+{
+  is_recording_ = false;
+}
+
+
+/**
+ * The cells of each match are sorted so the gaps between them are small,
+ * mostly 1 along a row or the size of the grid up a column.  The order they
+ * were kept in is remembered so the rolls can be put in the same order.
+ */
+void NoDice::History::
+add_removed(Grid const& grid, MatchGroupList const& groups)
+{
+  bytes_.push_back(has_small_refills(grid) ? record_step : record_wide_step);
+  put(unsigned(groups.size()));
+  order_.clear();
+  roll_groups_.clear();
+  for (auto const& group: groups)
+  {
+    int const first = int(order_.size());
+    for (std::size_t i = 0; i < group.cells.size(); ++i)
+      order_.push_back(first + int(i));
+    std::sort(order_.begin() + first, order_.end(),
+              [&](int lhs, int rhs)
+              {
+                return cell_index(grid, group.cells[lhs - first])
+                     < cell_index(grid, group.cells[rhs - first]);
+              });
+
+    roll_groups_.push_back(RollGroup{ int(group.cells.size()), bytes_.size() });
+    bytes_.push_back(Byte(group.shape));
+    put(unsigned(group.cells.size()));
+    int previous = 0;
+    for (auto it = order_.begin() + first; it != order_.end(); ++it)
+    {
+      int const cell = cell_index(grid, group.cells[*it - first]);
+      put(unsigned(cell - previous));
+      previous = cell;
+    }
+  }
+}
+
+
+void NoDice::History::
+add_score(std::vector<int> const& rolls, int bonus)
+{
+  auto const roll = [&](std::size_t i, std::size_t end)
+  {
+    return i < end && std::size_t(order_[i]) < rolls.size() ? rolls[order_[i]] : 0;
+  };
+
+  std::size_t first = 0;
+  for (auto const& group: roll_groups_)
+  {
+    std::size_t const end = first + group.size;
+    bool is_small = true;
+    for (std::size_t i = first; i < end; ++i)
+      is_small = is_small && roll(i, end) < 16;
+
+    if (is_small)
+    {
+      bytes_[group.shape_at] |= small_rolls;
+      for (std::size_t i = first; i < end; i += 2)
+        bytes_.push_back(Byte(roll(i, end) | (roll(i + 1, end) << 4)));
+    }
+    else
+    {
+      for (std::size_t i = first; i < end; ++i)
+        bytes_.push_back(Byte(roll(i, end)));
+    }
+    first = end;
+  }
+  put(unsigned(bonus));
+}
+
+
+void NoDice::History::
+add_refills(Grid const& grid, Grid::CellList const& empties)
+{
+  auto const code = [&](std::size_t i, unsigned none)
+  {
+    if (i >= empties.size())
+      return none;
+    return refill_code(grid.at(empties[i].x, empties[i].y), none);
+  };
+
+  if (has_small_refills(grid))
+  {
+    for (std::size_t i = 0; i < order_.size(); i += 2)
+      bytes_.push_back(Byte(code(i, no_refill) | (code(i + 1, no_refill) << 4)));
+  }
+  else
+  {
+    for (std::size_t i = 0; i < order_.size(); ++i)
+      bytes_.push_back(Byte(code(i, no_wide_refill)));
+  }
+}
+
+
+void NoDice::History::
+begin_rearrange(Grid const& grid)
+{
+  before_.resize(grid.size() * grid.size());
+  for (int y = 0; y < grid.size(); ++y)
+  {
+    for (int x = 0; x < grid.size(); ++x)
+      before_[x + y * grid.size()] = grid.at(x, y);
+  }
+}
+
+
+void NoDice::History::
+end_rearrange(Grid const& grid)
+{
+  unsigned count = 0;
+  for (int y = 0; y < grid.size(); ++y)
+  {
+    for (int x = 0; x < grid.size(); ++x)
+      count += (grid.at(x, y) != before_[x + y * grid.size()]);
+  }
+  if (count == 0)
+    return;
+
+  if (!is_recording_)
+    begin_turn();
+  bytes_.push_back(record_rearrange);
+  put(count);
+  int previous = 0;
+  for (int cell = 0; cell < grid.size() * grid.size(); ++cell)
+  {
+    Vector2i const p = cell_at(grid, cell);
+    if (grid.at(p.x, p.y) != before_[cell])
+    {
+      put(unsigned(cell - previous));
+      previous = cell;
+      bytes_.push_back(Byte(before_[cell]));
+      bytes_.push_back(Byte(grid.at(p.x, p.y)));
+    }
+  }
+}
+
+
+/**
+ * Reads the cells cleared in a step into cleared_, as cell numbers with their
+ * shapes, and the size of each match and how its rolls are kept into
+ * roll_groups_.
+ * @param[in] at where the step starts, at its kind
+ * @returns where the step's rolls start
+ */
+std::size_t NoDice::History::
+read_step(std::size_t at)
+{
+  ++at;
+  cleared_.clear();
+  roll_groups_.clear();
+  unsigned const group_count = get(at);
+  for (unsigned g = 0; g < group_count; ++g)
+  {
+    roll_groups_.push_back(RollGroup{ 0, at });
+    ShapeId const shape = ShapeId(bytes_[at++] & ~small_rolls);
+    unsigned const n = get(at);
+    roll_groups_.back().size = int(n);
+    int cell = 0;
+    for (unsigned i = 0; i < n; ++i)
+    {
+      cell += int(get(at));
+      cleared_.push_back(std::make_pair(cell, shape));
+    }
+  }
+  return at;
+}
+
+
+/**
+ * Finds where each record of a turn starts, by stepping over them from the
+ * start of the turn.
+ */
+void NoDice::History::
+find_records(std::size_t turn)
+{
+  std::size_t const end = (turn + 1 < turns_.size()) ? turns_[turn + 1] : bytes_.size();
+  records_.clear();
+  std::size_t at = turns_[turn];
+  while (at < end)
+  {
+    records_.push_back(at);
+    Byte const kind = bytes_[at];
+    if (kind == record_swap)
+    {
+      ++at;
+      get(at);
+      get(at);
+    }
+    else if (is_step(kind))
+    {
+      at = read_step(at);
+      roll_total(at);
+      get(at);
+      at += (kind == record_step) ? (cleared_.size() + 1) / 2 : cleared_.size();
+    }
+    else
+    {
+      ++at;
+      unsigned const n = get(at);
+      for (unsigned i = 0; i < n; ++i)
+      {
+        get(at);
+        at += 2;
+      }
+    }
+  }
+}
+
+
+/**
+ * Adds up the rolls of the step last read by read_step().
+ * @param[in,out] at where the rolls start, moved on to just past them
+ */
+int NoDice::History::
+roll_total(std::size_t& at) const
+{
+  int total = 0;
+  for (auto const& group: roll_groups_)
+  {
+    if (bytes_[group.shape_at] & small_rolls)
+    {
+      for (int i = 0; i < group.size; ++i)
+        total += (bytes_[at + i / 2] >> (4 * (i % 2))) & 0xf;
+      at += (group.size + 1) / 2;
+    }
+    else
+    {
+      for (int i = 0; i < group.size; ++i)
+        total += bytes_[at++];
+    }
+  }
+  return total;
+}
+
+
+int NoDice::History::
+step_score(std::size_t at)
+{
+  at = read_step(at);
+  int const total = roll_total(at);
+  return total + int(get(at));
+}
+
+
+/**
+ * The cleared cells are put back a column at a time, from the top down.
+ * Above the lowest cleared cell in a column the column now holds the shapes
+ * that fell, packed together in order, with the refills on top; each cleared
+ * cell gets its old shape back and the rest take the shapes that fell, from
+ * the top one down, which only ever reads cells below the one being written.
+ */
+void NoDice::History::
+undo_step(Grid& grid, std::size_t at, Grid::CellList& changed)
+{
+  read_step(at);
+  int const size = grid.size();
+  std::sort(cleared_.begin(), cleared_.end(),
+            [size](std::pair<int, ShapeId> const& lhs,
+                   std::pair<int, ShapeId> const& rhs)
+            {
+              int const lx = lhs.first % size;
+              int const rx = rhs.first % size;
+              return lx < rx || (lx == rx && lhs.first < rhs.first);
+            });
+
+  std::size_t first = 0;
+  while (first < cleared_.size())
+  {
+    int const x = cleared_[first].first % size;
+    std::size_t last = first;
+    while (last < cleared_.size() && cleared_[last].first % size == x)
+      ++last;
+
+    int from = size - 1 - int(last - first);
+    std::size_t next = last;
+    for (int y = size - 1; y >= cleared_[first].first / size; --y)
+    {
+      if (next > first && cleared_[next - 1].first / size == y)
+      {
+        --next;
+        grid.set(x, y, cleared_[next].second);
+      }
+      else
+      {
+        grid.set(x, y, grid.at(x, from--));
+      }
+      changed.push_back(Vector2i(x, y));
+    }
+    first = last;
+  }
+}
+
+
+void NoDice::History::
+redo_step(Grid& grid, std::size_t at, Grid::CellList& changed)
+{
+  bool const is_wide = (bytes_[at] == record_wide_step);
+  at = read_step(at);
+  for (auto const& cell: cleared_)
+  {
+    Vector2i const p = cell_at(grid, cell.first);
+    grid.set(p.x, p.y, no_shape);
+  }
+  roll_total(at);
+  get(at);
+
+  grid.collapse(falls_, empties_);
+  for (auto const& fall: falls_)
+  {
+    changed.push_back(Vector2i(fall.x, fall.from_y));
+    changed.push_back(Vector2i(fall.x, fall.to_y));
+  }
+  for (std::size_t i = 0; i < empties_.size() && i < cleared_.size(); ++i)
+  {
+    unsigned const code = is_wide
+                        ? bytes_[at + i]
+                        : (bytes_[at + i / 2] >> (4 * (i % 2))) & 0xf;
+    bool const is_empty = (code == (is_wide ? no_wide_refill : no_refill));
+    grid.set(empties_[i].x, empties_[i].y, is_empty ? no_shape : ShapeId(code));
+    changed.push_back(empties_[i]);
+  }
+}
+
+
+int NoDice::History::
+undo(Grid& grid, Grid::CellList& changed)
+{
+  changed.clear();
+  if (done_count_ == 0)
+    return 0;
+
+  is_recording_ = false;
+  --done_count_;
+  find_records(done_count_);
+  int score = 0;
+  for (auto it = records_.rbegin(); it != records_.rend(); ++it)
+  {
+    std::size_t at = *it;
+    Byte const kind = bytes_[at++];
+    if (kind == record_swap)
+    {
+      Vector2i const p1 = cell_at(grid, int(get(at)));
+      Vector2i const p2 = cell_at(grid, int(get(at)));
+      grid.swap(p1, p2);
+      changed.push_back(p1);
+      changed.push_back(p2);
+    }
+    else if (is_step(kind))
+    {
+      score += step_score(*it);
+      undo_step(grid, *it, changed);
+    }
+    else
+    {
+      unsigned const n = get(at);
+      int cell = 0;
+      for (unsigned i = 0; i < n; ++i, at += 2)
+      {
+        cell += int(get(at));
+        Vector2i const p = cell_at(grid, cell);
+        grid.set(p.x, p.y, ShapeId(bytes_[at]));
+        changed.push_back(p);
+      }
+    }
+  }
+  return score;
+}
+
+
+int NoDice::History::
+redo(Grid& grid, Grid::CellList& changed)
+{
+  changed.clear();
+  if (done_count_ == turns_.size())
+    return 0;
+
+  is_recording_ = false;
+  find_records(done_count_);
+  ++done_count_;
+  int score = 0;
+  for (std::size_t const record: records_)
+  {
+    std::size_t at = record;
+    Byte const kind = bytes_[at++];
+    if (kind == record_swap)
+    {
+      Vector2i const p1 = cell_at(grid, int(get(at)));
+      Vector2i const p2 = cell_at(grid, int(get(at)));
+      grid.swap(p1, p2);
+      changed.push_back(p1);
+      changed.push_back(p2);
+    }
+    else if (is_step(kind))
+    {
+      score += step_score(record);
+      redo_step(grid, record, changed);
+    }
+    else
+    {
+      unsigned const n = get(at);
+      int cell = 0;
+      for (unsigned i = 0; i < n; ++i, at += 2)
+      {
+        cell += int(get(at));
+        Vector2i const p = cell_at(grid, cell);
+        grid.set(p.x, p.y, ShapeId(bytes_[at + 1]));
+        changed.push_back(p);
+      }
+    }
+  }
+  return score;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file nodice/history.h
+ * @brief Public interface of the nodice/history module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_HISTORY_H
+#define NODICE_HISTORY_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include "nodice/grid.h"
+#include "nodice/pattern.h"
+#include <utility>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * An undo and redo history of the turns played on a grid, kept as the
+   * changes each turn made rather than copies of the grid.
+   *
+   * A turn is recorded as it is played: the swap, then for each step of the
+   * cascade the cells that were cleared with the shapes they held, the roll
+   * each die scored and the bonus on top, and the shapes dropped into the
+   * empty cells at the top.  Where the shapes fell is not kept, since it
+   * follows from which cells were cleared.  Turns that move dice around
+   * wholesale, like a reshuffle or a rotation, are kept as the cells that
+   * changed with their old and new shapes.
+   *
+   * Everything is packed into one array of bytes.  The cleared cells of each
+   * match are kept in order as the gaps between them, which mostly fit in a
+   * byte, with the match's shape once; a roll under 16 and a refilled shape
+   * take half a byte each, or a whole byte for a shape on a grid with 15 or
+   * more shapes.  A move that clears a hundred dice takes about three hundred
+   * bytes.  Undoing or redoing a turn takes time in proportion to the cells
+   * it changed.
+   *
+   * Recording a new turn drops any turns that had been undone.
+   */
+  class History
+  {
+  public:
+    typedef std::uint8_t Byte;
+
+  public:
+    History();
+
+    /** Gets the number of turns that can be undone. */
+    std::size_t
+    undo_count() const;
+
+    /** Gets the number of turns that can be redone. */
+    std::size_t
+    redo_count() const;
+
+    /** Gets the number of bytes the history takes up. */
+    std::size_t
+    byte_count() const;
+
+    /** Forgets every turn. */
+    void
+    clear();
+
+    /**
+     * Starts recording a turn made by swapping two cells.  Call it once the
+     * swap has been made and found to make a match.
+     */
+    void
+    begin_move(Grid const& grid, Grid::Move const& swap);
+
+    /** Finishes recording a move once the grid has settled. */
+    void
+    end_move();
+
+    /**
+     * Records the cells cleared in a step of the cascade.
+     * @param[in] grid   the grid
+     * @param[in] groups the matches to be cleared
+     */
+    void
+    add_removed(Grid const& grid, MatchGroupList const& groups);
+
+    /**
+     * Records the score of a step of the cascade: a roll for each die cleared,
+     * in the same order as the cells of the groups given to add_removed(),
+     * and a bonus.
+     */
+    void
+    add_score(std::vector<int> const& rolls, int bonus);
+
+    /**
+     * Records the shapes dropped into the empty cells after a step of the
+     * cascade.  Call it once they have been refilled.
+     * @param[in] grid    the grid, holding the new shapes
+     * @param[in] empties the cells that were refilled, as given by collapse()
+     */
+    void
+    add_refills(Grid const& grid, Grid::CellList const& empties);
+
+    /**
+     * Notes the cells of a grid before something moves them all around.  If
+     * it happens while a move is being recorded it is part of the move, and
+     * undoing one undoes both; otherwise it is a turn of its own.
+     */
+    void
+    begin_rearrange(Grid const& grid);
+
+    /** Records what changed since begin_rearrange(). */
+    void
+    end_rearrange(Grid const& grid);
+
+    /**
+     * Takes back the last turn.
+     * @param[in,out] grid    the grid the turn was played on, as it was left
+     * @param[out]    changed receives every cell that was changed
+     * @returns the score the turn made, or 0 if there was nothing to undo
+     */
+    int
+    undo(Grid& grid, Grid::CellList& changed);
+
+    /**
+     * Plays the last turn undone over again, exactly as it went before.
+     * @param[in,out] grid    the grid, as the undo left it
+     * @param[out]    changed receives every cell that was changed
+     * @returns the score the turn made, or 0 if there was nothing to redo
+     */
+    int
+    redo(Grid& grid, Grid::CellList& changed);
+
+  private:
+    void
+    begin_turn();
+
+    void
+    put(unsigned value);
+
+    unsigned
+    get(std::size_t& at) const;
+
+    std::size_t
+    read_step(std::size_t at);
+
+    int
+    roll_total(std::size_t& at) const;
+
+    void
+    find_records(std::size_t turn);
+
+    int
+    step_score(std::size_t at);
+
+    void
+    undo_step(Grid& grid, std::size_t at, Grid::CellList& changed);
+
+    void
+    redo_step(Grid& grid, std::size_t at, Grid::CellList& changed);
+
+  private:
+    /** The size of a match in a step and where its shape is kept. */
+    struct RollGroup
+    {
+      int         size;
+      std::size_t shape_at;
+    };
+
+    std::vector<Byte>        bytes_;
+    std::vector<std::size_t> turns_;       ///< where each turn starts in bytes_
+    std::size_t              done_count_;  ///< the turns not undone
+    bool                     is_recording_;
+    std::vector<int>         order_;       ///< the order the last step's cells were kept in
+    std::vector<RollGroup>   roll_groups_; ///< the matches of the last step
+    std::vector<ShapeId>     before_;      ///< the cells before a rearrange
+    std::vector<std::size_t> records_;     ///< where each record of a turn starts
+    std::vector<std::pair<int, ShapeId>> cleared_;
+    Grid::FallList           falls_;
+    Grid::CellList           empties_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_HISTORY_H
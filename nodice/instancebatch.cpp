@@ -0,0 +1,123 @@
+/**
+ * @file nodice/instancebatch.cpp
+ * @brief Implemntation of the nodice/instancebatch module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/instancebatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include "nodice/glstate.h"
+#include "nodice/mesharena.h"
+#include "nodice/shape.h"
+
+
+namespace
+{
+  inline GLubyte
+  to_byte(float c)
+  {
+    return GLubyte(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+  }
+} // anonymous namespace
+
+
+NoDice::InstanceBatch::
+InstanceBatch()
+: instances_(shapeRegistry().size())
+{
+}
+
+
+void NoDice::InstanceBatch::
+clear()
+{
+  for (auto& instances: instances_)
+  {
+    instances.x.clear();
+    instances.y.clear();
+    instances.z.clear();
+    instances.x_angle.clear();
+    instances.y_angle.clear();
+    instances.rgba.clear();
+  }
+}
+
+
+void NoDice::InstanceBatch::
+add(ShapeId shape, Vector3f const& position, float x_angle, float y_angle,
+    Colour const& colour)
+{
+  Instances& instances = instances_[shape];
+  instances.x.push_back(position.x);
+  instances.y.push_back(position.y);
+  instances.z.push_back(position.z);
+  instances.x_angle.push_back(x_angle);
+  instances.y_angle.push_back(y_angle);
+  for (int c = 0; c < 4; ++c)
+    instances.rgba.push_back(to_byte(colour[c]));
+}
+
+
+/**
+ * Each die is drawn as if by glTranslatef(), glRotatef() about x then about y,
+ * and glScalef() to undo the packing of the arena's positions, all folded
+ * into the one matrix T.Rx.Ry.S so that it takes a single glMultMatrixf().
+ */
+void NoDice::InstanceBatch::
+draw()
+{
+  GlState& state = glState();
+  state.enable(GL_RESCALE_NORMAL);
+  state.disable(GL_CULL_FACE);
+  meshArena().bind();
+  glMatrixMode(GL_MODELVIEW);
+
+  float const to_radians = float(M_PI) / 180.0f;
+  float const scale = 1.0f / float(MeshArena::position_unit);
+  for (std::size_t id = 0; id < instances_.size(); ++id)
+  {
+    Instances const& instances = instances_[id];
+    MeshArena::Range const& range = shapeRegistry().get(ShapeId(id)).mesh();
+    GLvoid const* const indexes = meshArena().index_offset(range);
+    for (std::size_t i = 0; i < instances.x.size(); ++i)
+    {
+      float const sa = std::sin(instances.x_angle[i] * to_radians);
+      float const ca = std::cos(instances.x_angle[i] * to_radians);
+      float const sb = std::sin(instances.y_angle[i] * to_radians);
+      float const cb = std::cos(instances.y_angle[i] * to_radians);
+      GLfloat const m[16] = {
+        cb * scale,  sa * sb * scale, -ca * sb * scale, 0.0f,
+        0.0f,        ca * scale,       sa * scale,      0.0f,
+        sb * scale, -sa * cb * scale,  ca * cb * scale, 0.0f,
+        instances.x[i], instances.y[i], instances.z[i], 1.0f
+      };
+      GLubyte const* rgba = &instances.rgba[i * 4];
+
+      glPushMatrix();
+      glMultMatrixf(m);
+      glColor4ub(rgba[0], rgba[1], rgba[2], rgba[3]);
+      glDrawElements(GL_TRIANGLES, range.index_count, GL_UNSIGNED_SHORT, indexes);
+      glPopMatrix();
+    }
+  }
+
+  meshArena().unbind();
+}
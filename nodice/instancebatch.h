@@ -0,0 +1,92 @@
+/**
+ * @file nodice/instancebatch.h
+ * @brief Public interface of the nodice/instancebatch module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_INSTANCEBATCH_H
+#define NODICE_INSTANCEBATCH_H 1
+
+#include "nodice/colour.h"
+#include "nodice/dice.h"
+#include "nodice/maths.h"
+#include "nodice/opengl.h"
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * Draws a board full of dice shape by shape, with the buffers set up once.
+   *
+   * The dice to draw are gathered first, into an instance buffer for each
+   * shape holding where each die is, how far it has spun and its colour.
+   * Then the mesh arena is bound once for the whole board, and each die is
+   * drawn straight from it with its own modelview matrix and colour and one
+   * glDrawElements() of its shape's range.  Fixed-function GL has no
+   * instanced drawing, but this way the only things that change between dice
+   * are a matrix and a colour: the vertexes never leave the GL buffers and
+   * are never touched by the CPU.
+   *
+   * The dice are drawn with additive blending and no depth test, so drawing
+   * them shape by shape instead of cell by cell looks just the same.
+   */
+  class InstanceBatch
+  {
+  public:
+    /** Constructs an empty batch for the shapes in the shape registry. */
+    InstanceBatch();
+
+    /** Empties the batch. */
+    void
+    clear();
+
+    /**
+     * Adds a die to the batch.
+     * @param[in] shape    the shape of the die
+     * @param[in] position where the die is
+     * @param[in] x_angle  how far the die has spun about the x axis, in degrees
+     * @param[in] y_angle  how far the die has spun about the y axis, in degrees
+     * @param[in] colour   the colour of the die
+     */
+    void
+    add(ShapeId shape, Vector3f const& position, float x_angle, float y_angle,
+        Colour const& colour);
+
+    /** Draws every die in the batch. */
+    void
+    draw();
+
+  private:
+    /** The dice of one shape waiting to be drawn. */
+    struct Instances
+    {
+      std::vector<GLfloat> x, y, z;
+      std::vector<GLfloat> x_angle, y_angle;
+      std::vector<GLubyte> rgba;
+    };
+
+  private:
+    std::vector<Instances> instances_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_INSTANCEBATCH_H
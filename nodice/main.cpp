@@ -23,6 +23,7 @@
 #include <iostream>
 #include "nodice/app.h"
 #include "nodice/config.h"
+#include "nodice/console.h"
 #include <SDL_main.h>
 #include <stdexcept>
 
@@ -73,6 +74,8 @@ int main(int argc, char* argv[])
 	{
 		std::cerr << PACKAGE_STRING << "\n";
 		Config config(argc, argv);
+		if (config.is_console_mode())
+			return NoDice::run_console(config, std::cin, std::cout);
 		return NoDice::App(&config).run();
 
 	}
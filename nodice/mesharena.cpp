@@ -0,0 +1,159 @@
+/**
+ * @file nodice/mesharena.cpp
+ * @brief Implemntation of the nodice/mesharena module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/mesharena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "nodice/glstate.h"
+#include "nodice/maths.h"
+
+
+namespace
+{
+  static const int row_width = NoDice::coords_per_vertex
+                             + NoDice::coords_per_normal;
+
+  /** Scales a value from -1 to 1 into a signed integer with @p unit steps. */
+  inline long
+  pack(float value, int unit)
+  {
+    return std::lround(std::min(std::max(value, -1.0f), 1.0f) * float(unit));
+  }
+
+  NoDice::MeshArena::Vertex
+  pack_vertex(float const* row)
+  {
+    typedef NoDice::MeshArena MeshArena;
+
+    float const* normal = row + NoDice::coords_per_vertex;
+    float length = std::sqrt(normal[0] * normal[0]
+                           + normal[1] * normal[1]
+                           + normal[2] * normal[2]);
+    if (length == 0.0f)
+      length = 1.0f;
+
+    MeshArena::Vertex vertex;
+    for (int i = 0; i < 3; ++i)
+    {
+      vertex.position[i] = GLshort(pack(row[i], MeshArena::position_unit));
+      vertex.normal[i] = GLbyte(pack(normal[i] / length, MeshArena::normal_unit));
+    }
+    vertex.position[3] = 0;
+    vertex.normal[3] = 0;
+    return vertex;
+  }
+} // anonymous namespace
+
+
+NoDice::MeshArena::
+MeshArena()
+: vbo_(0)
+, ibo_(0)
+, is_loaded_(false)
+{
+}
+
+
+NoDice::MeshArena::
+~MeshArena()
+{
+  if (vbo_)
+    glDeleteBuffers(1, &vbo_);
+  if (ibo_)
+    glDeleteBuffers(1, &ibo_);
+}
+
+
+NoDice::MeshArena::Range NoDice::MeshArena::
+add(MeshBuilder const& mesh)
+{
+  Range const range{ GLint(vertexes_.size()),
+                     GLsizei(mesh.vertex_count()),
+                     GLint(indexes_.size()),
+                     GLsizei(mesh.indexes().size()) };
+  for (int v = 0; v < mesh.vertex_count(); ++v)
+    vertexes_.push_back(pack_vertex(&mesh.rows()[v * row_width]));
+  for (MeshBuilder::Index i: mesh.indexes())
+    indexes_.push_back(GLushort(range.first_vertex + i));
+  is_loaded_ = false;
+  return range;
+}
+
+
+void NoDice::MeshArena::
+bind() const
+{
+  static const int stride = sizeof(Vertex);
+  static const GLbyte* base = 0;
+  static const GLbyte* positions = base + offsetof(Vertex, position);
+  static const GLbyte* normals = base + offsetof(Vertex, normal);
+
+  if (!vbo_)
+  {
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ibo_);
+  }
+  GlState& state = glState();
+  state.bind_buffer(GL_ARRAY_BUFFER, vbo_);
+  state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+  if (!is_loaded_)
+  {
+    glBufferData(GL_ARRAY_BUFFER, vertexes_.size() * sizeof(Vertex),
+                 vertexes_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexes_.size() * sizeof(GLushort),
+                 indexes_.data(), GL_STATIC_DRAW);
+    is_loaded_ = true;
+  }
+  state.enable_client_state(GL_VERTEX_ARRAY);
+  state.enable_client_state(GL_NORMAL_ARRAY);
+  glVertexPointer(coords_per_vertex, GL_SHORT, stride, positions);
+  glNormalPointer(GL_BYTE, stride, normals);
+}
+
+
+void NoDice::MeshArena::
+unbind() const
+{
+  GlState& state = glState();
+  state.disable_client_state(GL_NORMAL_ARRAY);
+  state.disable_client_state(GL_VERTEX_ARRAY);
+  state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  state.bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+GLvoid const* NoDice::MeshArena::
+index_offset(Range const& range) const
+{
+  static const GLushort* base = 0;
+  return base + range.first_index;
+}
+
+
+NoDice::MeshArena& NoDice::
+meshArena()
+{
+  static MeshArena s_arena;
+  return s_arena;
+}
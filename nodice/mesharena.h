@@ -0,0 +1,132 @@
+/**
+ * @file nodice/mesharena.h
+ * @brief Public interface of the nodice/mesharena module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_MESHARENA_H
+#define NODICE_MESHARENA_H 1
+
+#include "nodice/meshbuilder.h"
+#include "nodice/opengl.h"
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * One vertex buffer and one index buffer holding the meshes of every shape.
+   *
+   * Each shape puts its indexed triangles in the arena once and gets back
+   * where its vertexes and indexes start and how many there are.  The indexes
+   * are stored counting from the start of the arena, so binding the arena sets
+   * up the vertex and normal arrays for all the shapes at once and any number
+   * of shapes can then be drawn with glDrawElements() and their ranges without
+   * touching the buffer bindings again.
+   *
+   * The indexes are unsigned shorts, the only kind GLES 1.1 has, so the arena
+   * holds at most 65536 vertexes.
+   *
+   * The vertexes are packed into 12 bytes each.  The positions are shorts in
+   * units of 1/position_unit, which is fine enough for shapes that fit in
+   * the unit sphere, and have to be scaled back by the modelview matrix.  The
+   * normals are made unit length and stored as bytes, which GL maps back on
+   * to -1 to 1 itself, so they only need GL_RESCALE_NORMAL to undo a uniform
+   * scale instead of GL_NORMALIZE on every vertex.
+   */
+  class MeshArena
+  {
+  public:
+    /** Where a mesh is in the arena. */
+    struct Range
+    {
+      GLint   first_vertex;   ///< the first vertex of the mesh
+      GLsizei vertex_count;   ///< the number of vertexes in the mesh
+      GLint   first_index;    ///< the first index of the mesh
+      GLsizei index_count;    ///< the number of indexes in the mesh
+    };
+
+    /** A vertex packed for the vertex buffer. */
+    struct Vertex
+    {
+      GLshort position[4];   ///< x, y, z in position_units, then padding
+      GLbyte  normal[4];     ///< unit x, y, z in 127ths, then padding
+    };
+
+    /** The number of steps a vertex position has from 0 to 1. */
+    static const int position_unit = 32767;
+
+    /** The number of steps a normal has from 0 to 1. */
+    static const int normal_unit = 127;
+
+  public:
+    /** Constructs an empty arena. */
+    MeshArena();
+
+    /** Destroys the arena and its buffers. */
+    ~MeshArena();
+
+    /**
+     * Adds a mesh to the end of the arena.
+     * @param[in] mesh the rows of a vertex and a normal and the indexes of the
+     *                 triangles, with every vertex inside the unit sphere
+     * @returns where the mesh is in the arena
+     */
+    Range
+    add(MeshBuilder const& mesh);
+
+    /**
+     * Binds the arena's buffers and points the vertex and normal arrays into
+     * them, loading the buffers first if meshes have been added since they
+     * were last loaded.
+     */
+    void
+    bind() const;
+
+    /** Turns the vertex and normal arrays off and unbinds the buffers. */
+    void
+    unbind() const;
+
+    /**
+     * Gets where a mesh's indexes start in the bound index buffer, to hand to
+     * glDrawElements().
+     */
+    GLvoid const*
+    index_offset(Range const& range) const;
+
+  private:
+    MeshArena(MeshArena const&);
+    MeshArena& operator=(MeshArena const&);
+
+  private:
+    std::vector<Vertex>   vertexes_;
+    std::vector<GLushort> indexes_;
+    mutable GLuint        vbo_;
+    mutable GLuint        ibo_;
+    mutable bool          is_loaded_;
+  };
+
+  /** Gets the arena all the shapes put their meshes in. */
+  MeshArena&
+  meshArena();
+
+} // namespace NoDice
+
+#endif // NODICE_MESHARENA_H
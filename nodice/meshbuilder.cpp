@@ -0,0 +1,278 @@
+/**
+ * @file nodice/meshbuilder.cpp
+ * @brief Implemntation of the nodice/meshbuilder module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/meshbuilder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+
+namespace
+{
+  typedef NoDice::MeshBuilder::Index Index;
+
+  static const int row_width = NoDice::MeshBuilder::row_width;
+
+  /** The bits of a row, so rows can be welded only when exactly equal. */
+  typedef std::array<std::uint32_t, row_width> RowKey;
+
+  struct RowKeyHash
+  {
+    std::size_t
+    operator()(RowKey const& key) const
+    {
+      std::size_t h = 14695981039346656037ull;
+      for (std::uint32_t word: key)
+        h = (h ^ word) * 1099511628211ull;
+      return h;
+    }
+  };
+
+  typedef std::unordered_map<RowKey, Index, RowKeyHash> RowMap;
+
+  RowKey
+  row_key(float const* row)
+  {
+    RowKey key;
+    for (int i = 0; i < row_width; ++i)
+    {
+      float const f = row[i] + 0.0f;  // so -0 welds with +0
+      std::memcpy(&key[i], &f, sizeof(f));
+    }
+    return key;
+  }
+
+  /**
+   * Scores a vertex for Forsyth's ordering: more for being near the front of
+   * the cache, and more for having few triangles left to draw, so that lone
+   * vertexes get finished off instead of left for later.
+   */
+  float
+  vertex_score(int cache_position, int live_triangles, int cache_size)
+  {
+    static const float last_triangle_score = 0.75f;
+    static const float cache_decay_power   = 1.5f;
+    static const float valence_boost_scale = 2.0f;
+    static const float valence_boost_power = 0.5f;
+
+    if (live_triangles == 0)
+      return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0 && cache_position < cache_size)
+    {
+      if (cache_position < 3)
+        score = last_triangle_score;
+      else
+      {
+        float const scale = 1.0f / float(cache_size - 3);
+        score = std::pow(1.0f - float(cache_position - 3) * scale,
+                         cache_decay_power);
+      }
+    }
+    return score + valence_boost_scale
+                 * std::pow(float(live_triangles), -valence_boost_power);
+  }
+} // anonymous namespace
+
+
+NoDice::MeshBuilder::
+MeshBuilder()
+{ }
+
+
+void NoDice::MeshBuilder::
+clear()
+{
+  rows_.clear();
+  indexes_.clear();
+}
+
+
+void NoDice::MeshBuilder::
+add_triangles(float const* rows, int vertex_count)
+{
+  RowMap welded;
+  for (int v = 0; v < this->vertex_count(); ++v)
+    welded.emplace(row_key(&rows_[v * row_width]), Index(v));
+
+  for (int v = 0; v < vertex_count; ++v)
+  {
+    float const* row = rows + v * row_width;
+    auto const found = welded.emplace(row_key(row), Index(this->vertex_count()));
+    if (found.second)
+      rows_.insert(rows_.end(), row, row + row_width);
+    indexes_.push_back(found.first->second);
+  }
+}
+
+
+void NoDice::MeshBuilder::
+optimize(int cache_size)
+{
+  int const vertex_count = this->vertex_count();
+  int const triangle_count = int(indexes_.size() / 3);
+
+  // the triangles using each vertex
+  std::vector<int> first_triangle(vertex_count + 1, 0);
+  for (Index i: indexes_)
+    ++first_triangle[i + 1];
+  for (int v = 0; v < vertex_count; ++v)
+    first_triangle[v + 1] += first_triangle[v];
+  std::vector<int> triangles(indexes_.size());
+  std::vector<int> fill(first_triangle.begin(), first_triangle.end() - 1);
+  for (std::size_t i = 0; i < indexes_.size(); ++i)
+    triangles[fill[indexes_[i]]++] = int(i / 3);
+
+  std::vector<int>   live(vertex_count);
+  std::vector<float> score(vertex_count);
+  for (int v = 0; v < vertex_count; ++v)
+  {
+    live[v] = first_triangle[v + 1] - first_triangle[v];
+    score[v] = vertex_score(-1, live[v], cache_size);
+  }
+
+  std::vector<float> triangle_score(triangle_count, 0.0f);
+  std::vector<bool>  is_drawn(triangle_count, false);
+  for (int t = 0; t < triangle_count; ++t)
+  {
+    for (int k = 0; k < 3; ++k)
+      triangle_score[t] += score[indexes_[t * 3 + k]];
+  }
+
+  std::vector<Index> ordered;
+  ordered.reserve(indexes_.size());
+  std::vector<int> cache;
+  std::vector<int> next_cache;
+  int best = -1;
+  for (int n = 0; n < triangle_count; ++n)
+  {
+    if (best < 0)
+    {
+      for (int t = 0; t < triangle_count; ++t)
+      {
+        if (!is_drawn[t] && (best < 0 || triangle_score[t] > triangle_score[best]))
+          best = t;
+      }
+    }
+
+    is_drawn[best] = true;
+    next_cache.clear();
+    for (int k = 0; k < 3; ++k)
+    {
+      Index const v = indexes_[best * 3 + k];
+      ordered.push_back(v);
+      --live[v];
+      next_cache.push_back(v);
+    }
+    for (int v: cache)
+    {
+      if (std::find(next_cache.begin(), next_cache.end(), v) == next_cache.end())
+        next_cache.push_back(v);
+    }
+    if (int(next_cache.size()) > cache_size)
+    {
+      for (std::size_t i = cache_size; i < next_cache.size(); ++i)
+        score[next_cache[i]] = vertex_score(-1, live[next_cache[i]], cache_size);
+      next_cache.resize(cache_size);
+    }
+    cache.swap(next_cache);
+    for (std::size_t i = 0; i < cache.size(); ++i)
+      score[cache[i]] = vertex_score(int(i), live[cache[i]], cache_size);
+
+    // only the triangles of cached vertexes can have changed score
+    best = -1;
+    for (int v: cache)
+    {
+      for (int i = first_triangle[v]; i < first_triangle[v + 1]; ++i)
+      {
+        int const t = triangles[i];
+        if (is_drawn[t])
+          continue;
+        triangle_score[t] = score[indexes_[t * 3]]
+                          + score[indexes_[t * 3 + 1]]
+                          + score[indexes_[t * 3 + 2]];
+        if (best < 0 || triangle_score[t] > triangle_score[best])
+          best = t;
+      }
+    }
+  }
+
+  // number the vertexes in the order they are first used
+  std::vector<int> renumber(vertex_count, -1);
+  std::vector<float> rows;
+  rows.reserve(rows_.size());
+  for (Index& i: ordered)
+  {
+    if (renumber[i] < 0)
+    {
+      renumber[i] = int(rows.size() / row_width);
+      rows.insert(rows.end(),
+                  rows_.begin() + i * row_width,
+                  rows_.begin() + (i + 1) * row_width);
+    }
+    i = Index(renumber[i]);
+  }
+  rows_.swap(rows);
+  indexes_.swap(ordered);
+}
+
+
+int NoDice::MeshBuilder::
+vertex_count() const
+{ return int(rows_.size() / row_width); }
+
+
+std::vector<float> const& NoDice::MeshBuilder::
+rows() const
+{ return rows_; }
+
+
+std::vector<NoDice::MeshBuilder::Index> const& NoDice::MeshBuilder::
+indexes() const
+{ return indexes_; }
+
+
+float NoDice::MeshBuilder::
+average_cache_miss_ratio(std::vector<Index> const& indexes, int cache_size)
+{
+  if (indexes.empty())
+    return 0.0f;
+
+  std::deque<Index> cache;
+  int misses = 0;
+  for (Index i: indexes)
+  {
+    if (std::find(cache.begin(), cache.end(), i) == cache.end())
+    {
+      ++misses;
+      cache.push_back(i);
+      if (int(cache.size()) > cache_size)
+        cache.pop_front();
+    }
+  }
+  return float(misses) / float(indexes.size() / 3);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file nodice/meshbuilder.h
+ * @brief Public interface of the nodice/meshbuilder module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_MESHBUILDER_H
+#define NODICE_MESHBUILDER_H 1
+
+#include <cstdint>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * Turns a triangle soup into indexed triangles.
+   *
+   * The shapes are generated as a list of triangles, three rows of a vertex
+   * and a normal to each, with every corner written out again for each
+   * triangle it is in.  The builder welds rows with the same vertex and
+   * normal into one, so a flat face made of several triangles shares its
+   * corners, and gives the triangles as indexes into the welded rows.
+   *
+   * The triangles can then be put in an order that keeps reusing the vertexes
+   * a GPU has just transformed, which it keeps in a small FIFO cache.  The
+   * ordering is Tom Forsyth's greedy "linear-speed vertex cache
+   * optimisation": each step takes the triangle whose vertexes are most
+   * recently used and have the fewest triangles left to go.
+   *
+   * The builder knows nothing of OpenGL, so it can be used and tested
+   * without a video context.
+   */
+  class MeshBuilder
+  {
+  public:
+    typedef std::uint16_t Index;
+
+    /** The number of floats in a row: a vertex and a normal. */
+    static const int row_width = 6;
+
+    /** The number of vertexes the usual GPU vertex cache holds. */
+    static const int default_cache_size = 16;
+
+  public:
+    /** Constructs an empty mesh. */
+    MeshBuilder();
+
+    /** Empties the mesh. */
+    void
+    clear();
+
+    /**
+     * Adds a list of triangles, welding their rows to the ones already in the
+     * mesh.
+     * @param[in] rows         three rows for each triangle
+     * @param[in] vertex_count the number of rows
+     */
+    void
+    add_triangles(float const* rows, int vertex_count);
+
+    /**
+     * Puts the triangles in order for reuse of the post-transform vertex
+     * cache.  The vertexes are renumbered in the order they are first used.
+     * @param[in] cache_size the number of vertexes the cache holds
+     */
+    void
+    optimize(int cache_size = default_cache_size);
+
+    /** Gets the number of welded rows. */
+    int
+    vertex_count() const;
+
+    /** Gets the welded rows. */
+    std::vector<float> const&
+    rows() const;
+
+    /** Gets the indexes of the rows making up the triangles, three to each. */
+    std::vector<Index> const&
+    indexes() const;
+
+    /**
+     * Works out how many vertexes a FIFO vertex cache would have to transform
+     * for each triangle in a list, from 0.5 at best to 3 at worst.
+     */
+    static float
+    average_cache_miss_ratio(std::vector<Index> const& indexes,
+                             int                       cache_size = default_cache_size);
+
+  private:
+    std::vector<float> rows_;
+    std::vector<Index> indexes_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_MESHBUILDER_H
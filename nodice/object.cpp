@@ -19,31 +19,13 @@
  */
 #include "nodice/object.h"
 
-#include <cstdlib>
-#include "nodice/video.h"
-
-
-namespace
-{
-  static const int x_spin_speed = 1;
-  static const int y_spin_speed = 6;
-  static const float fade_rate = 20.0f;
-  static const float move_rate = 10.0f;
-}
-
 
 NoDice::Object::
-Object(const ShapePtr shape, const Vector3f& initialPosition)
+Object(ShapeId shape)
 : m_shape(shape)
-, m_colour(m_shape->defaultColour())
+, m_colour(shapeRegistry().get(m_shape).defaultColour())
 , m_normalColour(m_colour)
 , m_highlightColour(1.0f, 0.8f, 0.2f, 0.5f)
-, m_position(initialPosition)
-, m_velocity(0.0f, 0.0f, 0.0f)
-, m_isMoving(false)
-, m_isDisappearing(false)
-, m_fadeFactor(0.0f)
-, m_xrot(std::rand() % 180), m_yrot((std::rand()>>2) % 90)
 {
 }
 
@@ -54,16 +36,9 @@ NoDice::Object::
 }
 
 
-/**
- * The default type of an object is the name of it's shape.
- * Non-base objects can do something fancier.
- *
- * The name type allows two different objects to be compared for, say, the
- * purpose of matching.
- */
-const std::string& NoDice::Object::
+NoDice::ShapeId NoDice::Object::
 type() const
-{ return m_shape->name(); }
+{ return m_shape; }
 
 
 void NoDice::Object::
@@ -76,89 +51,18 @@ setHighlight(bool toggle)
 }
 
 
-void NoDice::Object::
-update() 
-{
-  if (m_isDisappearing)
-  {
-    m_colour.a -= m_fadeFactor;
-    if (this->hasDisappeared())
-    {
-      m_isDisappearing = false;
-      m_fadeFactor = 0.0f;
-    }
-  }
-  else
-  {
-    m_xrot = (m_xrot + x_spin_speed) % 360;
-    m_yrot = (m_yrot + y_spin_speed) % 360;
-  }
-  if (m_isMoving)
-  {
-    if (!isFalling())
-    {
-      m_isMoving = false;
-      m_velocity.set(0.0f, 0.0f, 0.0f);
-    }
-  }
-  m_position += m_velocity;
-}
-
-
 int NoDice::Object::
-score()
+score(Random& random)
 {
-  return m_shape->score();
+  return shapeRegistry().get(m_shape).score(random);
 }
 
 
 void NoDice::Object::
-draw() const
+draw(InstanceBatch& batch, const Vector3f& position,
+     float xrot, float yrot, float fade) const
 {
-  glMatrixMode(GL_MODELVIEW);
-  glPushMatrix();
-
-  glTranslatef(m_position.x, m_position.y, m_position.z);
-  glRotatef(float(m_xrot), 1.0f, 0.0f, 0.0f);
-  glRotatef(float(m_yrot), 0.0f, 1.0f, 0.0f);
-
-  glColor4fv(m_colour.rgba);
-  glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, m_colour.rgba);
-  m_shape->draw();
-  glPopMatrix();
+  Colour colour(m_colour);
+  colour.a *= fade;
+  batch.add(m_shape, position, xrot, yrot, colour);
 }
-
-
-void NoDice::Object::
-setVelocity(const Vector3f& velocity)
-{ m_velocity = velocity; }
-  
-
-bool NoDice::Object::
-hasDisappeared() const
-{ return m_colour.a <= 0.0f; }
-
-
-void NoDice::Object::
-startDisappearing()
-{
-  m_isDisappearing = true;
-  m_fadeFactor = m_colour.a / fade_rate;
-}
-
-
-bool NoDice::Object::
-isFalling() const
-{
-  return m_position.distanceSquared(m_newPosition) > 0.01;
-}
-
-
-void NoDice::Object::
-startFalling(const Vector3f& newPosition)
-{
-  m_isMoving = true;
-  m_newPosition = newPosition;
-  m_velocity = (m_newPosition - m_position) / move_rate;
-}
-
@@ -21,9 +21,10 @@
 #define NODICE_OBJECT_H 1
 
 #include "nodice/colour.h"
+#include "nodice/instancebatch.h"
 #include "nodice/maths.h"
+#include "nodice/pool.h"
 #include "nodice/shape.h"
-#include <memory>
 #include <vector>
 
 
@@ -34,84 +35,65 @@ namespace NoDice
   /**
    * An instance of a drawable object.
    *
-   * A drawable object instance has a shape, a transform (modelview matrix),
-   * a colour, and um, I dunno, other state.
+   * A drawable object instance has a shape, known by its ID in the shape
+   * registry, and a colour.  Where it is and how it is moving is kept by its
+   * board in an Animation, so a whole board of objects can be moved on in one
+   * pass.
    */
   class Object
   {
   public:
     /** Constructs the object with a given shape. */
-    Object(const ShapePtr shape, const Vector3f& initialPosition);
+    explicit Object(ShapeId shape);
 
     /** Destroys the object. */
     virtual ~Object();
 
-    /** Gets the name of the type of the object. */
-    virtual const std::string& type() const;
+    /**
+     * Gets the type of the object: the ID of its shape.  Two objects match
+     * if their types are equal.
+     */
+    virtual ShapeId type() const;
 
     /** Turns on highlight mode. */
     void setHighlight(bool toggle);
 
-    /** Performs a one-tick update of the object. */
-    virtual void update();
-
     /** Gets the current base score of the object. */
-    virtual int score();
-
-    /** Renders the object on the current drawing surface. */
-    virtual void draw() const;
-
-    void setVelocity(const Vector3f& velocity);
+    virtual int score(Random& random);
 
     /**
-     * @name Disappearance
-     * Member functions used to animate fading of an object.
+     * Adds the object to a batch to be drawn along with the others.
+     * @param[in] batch    the batch to draw the object in
+     * @param[in] position where to draw the object
+     * @param[in] xrot     how far the object has spun about the x axis
+     * @param[in] yrot     how far the object has spun about the y axis
+     * @param[in] fade     how visible the object is, from 0 to 1
      */
-    /*@{*/
-
-    /** Indicates if the object has completely disappeared. */
-    bool hasDisappeared() const;
-
-    /** Starts the object disappearing. */
-    void startDisappearing();
-    /*@}*/
-
-    /**
-     * @name Falling
-     * Member functions used to animate an object falling.
-     */
-    /*@{*/
-
-    /** Indicates if an object is still falling. */
-    bool isFalling() const;
-
-    /** Starts the object falling. */
-    void startFalling(const Vector3f& newPosition);
-    /*@}*/
+    virtual void draw(InstanceBatch&  batch,
+                      const Vector3f& position,
+                      float           xrot,
+                      float           yrot,
+                      float           fade) const;
 
   private:
     Object(const Object&);
     Object& operator=(const Object&);
 
   protected:
-    const ShapePtr m_shape;
+    const ShapeId  m_shape;
     Colour         m_colour;
     Colour         m_normalColour;
     Colour         m_highlightColour;
-    Vector3f       m_position;
-    Vector3f       m_velocity;
-    Vector3f       m_newPosition;
-    bool           m_isMoving;
-    bool           m_isDisappearing;
-    float          m_fadeFactor;
-    int            m_xrot, m_yrot; // temp for testing
   };
 
-  /** Points to an object. */
-  typedef std::shared_ptr<Object> ObjectPtr;
+  /** Storage for a fixed number of objects. */
+  typedef Pool<Object> ObjectPool;
+
+  /** Names an object in an ObjectPool. */
+  typedef ObjectPool::Handle ObjectHandle;
 
-  /** A collection of object pointers. */
-  typedef std::vector<ObjectPtr> ObjectBag;
+  /** A collection of objects owned by something else. */
+  typedef std::vector<Object*> ObjectBag;
 
   /** A collection of object bags. */
   typedef std::vector<ObjectBag> ObjectBrace;
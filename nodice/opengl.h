@@ -48,6 +48,9 @@ extern int smw_save_me(GL_GLEXT_PROTOTYPES);
 # ifndef GL_ARRAY_BUFFER
 #  define GL_ARRAY_BUFFER 0x8892
 # endif
+# ifndef GL_ELEMENT_ARRAY_BUFFER
+#  define GL_ELEMENT_ARRAY_BUFFER 0x8893
+# endif
 # ifndef GL_STATIC_DRAW
 #  define GL_STATIC_DRAW 0x88E4
 # endif
@@ -0,0 +1,368 @@
+/**
+ * @file nodice/pattern.cpp
+ * @brief Implemntation of the nodice/pattern module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/pattern.h"
+
+#include <algorithm>
+#include "nodice/bitboard.h"
+
+
+namespace
+{
+  using NoDice::Pattern;
+
+  typedef std::uint64_t Word;
+
+  static const int bits_per_word = NoDice::BitBoard::columns_per_word;
+
+  /** The most cells a pattern can span in either direction. */
+  static const int max_extent = 5;
+
+  /**
+   * A pattern drawn as rows of 'X' (a cell in the pattern) and '.' (a cell
+   * that can hold anything), top row first, with the rows split by '/'.  The
+   * picture is turned a quarter at a time to get the pattern's orientations.
+   */
+  struct PatternSpec
+  {
+    Pattern     pattern;
+    char const* picture;
+    int         orientations;
+  };
+
+  constexpr PatternSpec pattern_specs[] = {
+    { NoDice::pattern_line3, "XXX",          2 },
+    { NoDice::pattern_line4, "XXXX",         2 },
+    { NoDice::pattern_block, "XX/XX",        1 },
+    { NoDice::pattern_l,     "X../X../XXX",  4 },
+    { NoDice::pattern_t,     "XXX/.X./.X.",  4 },
+    { NoDice::pattern_line5, "XXXXX",        2 },
+    { NoDice::pattern_plus,  ".X./XXX/.X.",  1 },
+  };
+
+  /**
+   * One orientation of a pattern: bit dx of rows[dy] is set for each cell
+   * (x + dx, y + dy) of the pattern placed at (x, y).
+   */
+  struct Mask
+  {
+    Pattern      pattern;
+    int          width;
+    int          height;
+    std::uint8_t rows[max_extent];
+    int          first_dx;  ///< a cell that is always in the pattern
+    int          first_dy;
+  };
+
+  constexpr Mask
+  draw(PatternSpec const& spec)
+  {
+    Mask mask{ spec.pattern, 0, 1, { 0 }, 0, 0 };
+    for (char const* c = spec.picture; *c; ++c)
+      mask.height += (*c == '/');
+
+    int dy = mask.height - 1;
+    int dx = 0;
+    for (char const* c = spec.picture; *c; ++c)
+    {
+      if (*c == '/')
+      {
+        --dy;
+        dx = 0;
+        continue;
+      }
+      if (*c == 'X')
+        mask.rows[dy] |= std::uint8_t(1u << dx);
+      ++dx;
+      mask.width = std::max(mask.width, dx);
+    }
+    return mask;
+  }
+
+  /** Turns a mask a quarter turn: (dx, dy) goes to (dy, width - 1 - dx). */
+  constexpr Mask
+  turn(Mask const& mask)
+  {
+    Mask turned{ mask.pattern, mask.height, mask.width, { 0 }, 0, 0 };
+    for (int dy = 0; dy < mask.height; ++dy)
+    {
+      for (int dx = 0; dx < mask.width; ++dx)
+      {
+        if (mask.rows[dy] & (1u << dx))
+          turned.rows[mask.width - 1 - dx] |= std::uint8_t(1u << dy);
+      }
+    }
+    return turned;
+  }
+
+  constexpr Mask
+  find_first_cell(Mask mask)
+  {
+    for (int dy = mask.height - 1; dy >= 0; --dy)
+    {
+      for (int dx = mask.width - 1; dx >= 0; --dx)
+      {
+        if (mask.rows[dy] & (1u << dx))
+        {
+          mask.first_dx = dx;
+          mask.first_dy = dy;
+        }
+      }
+    }
+    return mask;
+  }
+
+  constexpr int
+  count_masks()
+  {
+    int count = 0;
+    for (auto const& spec: pattern_specs)
+      count += spec.orientations;
+    return count;
+  }
+
+  static const int mask_count = count_masks();
+
+  struct MaskTable
+  {
+    Mask masks[mask_count];
+  };
+
+  constexpr MaskTable
+  compile_patterns()
+  {
+    MaskTable table{};
+    int i = 0;
+    for (auto const& spec: pattern_specs)
+    {
+      Mask mask = draw(spec);
+      for (int turns = 0; turns < spec.orientations; ++turns)
+      {
+        table.masks[i++] = find_first_cell(mask);
+        mask = turn(mask);
+      }
+    }
+    return table;
+  }
+
+  /** Every orientation of every pattern, worked out by the compiler. */
+  constexpr MaskTable mask_table = compile_patterns();
+
+  static_assert(mask_table.masks[0].width == 3 && mask_table.masks[1].height == 3,
+                "a line of 3 should turn into a column of 3");
+
+  /** Gets bits x + shift onwards of a row as if they started at bit x. */
+  inline Word
+  shifted(Word const* row, int w, int words_per_row, int shift)
+  {
+    if (shift == 0)
+      return row[w];
+    Word const next = (w + 1 < words_per_row) ? row[w + 1] : 0;
+    return (row[w] >> shift) | (next << (bits_per_word - shift));
+  }
+
+  char const* const pattern_names[] = {
+    "line", "line of 4", "block", "L", "T", "line of 5", "cross"
+  };
+
+  int const pattern_bonuses[] = { 0, 2, 3, 4, 5, 8, 10 };
+} // anonymous namespace
+
+
+char const* NoDice::
+pattern_name(Pattern pattern)
+{
+  return pattern_names[pattern];
+}
+
+
+int NoDice::
+pattern_bonus(Pattern pattern)
+{
+  return pattern_bonuses[pattern];
+}
+
+
+NoDice::PatternMatcher::
+PatternMatcher(int size)
+: size_(size)
+, words_per_row_((size + bits_per_word - 1) / bits_per_word)
+, run_at_(size * size, -1)
+, group_at_(size * size, -1)
+, bits_(size * words_per_row_, 0)
+{ }
+
+
+/**
+ * The runs are joined with a union-find over the cells they pass through: a
+ * run is joined to any run it crosses or that runs alongside it.  The cells
+ * of each group are then gathered once each, in run order, and the lookup
+ * arrays are put back the way they were for next time.
+ */
+void NoDice::PatternMatcher::
+group(Grid const& grid, Grid::RunList const& runs, MatchGroupList& groups)
+{
+  groups.clear();
+  parents_.resize(runs.size());
+  for (std::size_t r = 0; r < runs.size(); ++r)
+    parents_[r] = int(r);
+
+  auto const join = [this](int a, int b)
+  {
+    parents_[find_root(a)] = find_root(b);
+  };
+
+  for (std::size_t r = 0; r < runs.size(); ++r)
+  {
+    Grid::Run const& run = runs[r];
+    for (int i = 0; i < run.length; ++i)
+    {
+      int const cell = (run.x + i * run.dx) + (run.y + i * run.dy) * size_;
+      if (run_at_[cell] >= 0)
+        join(int(r), run_at_[cell]);
+      run_at_[cell] = int(r);
+    }
+  }
+
+  for (std::size_t r = 0; r < runs.size(); ++r)
+  {
+    Grid::Run const& run = runs[r];
+    ShapeId const shape = grid.at(run.x, run.y);
+    for (int i = 0; i < run.length; ++i)
+    {
+      int const x = run.x + i * run.dx;
+      int const y = run.y + i * run.dy;
+      int const neighbours[4][2] = { { x-1, y }, { x+1, y }, { x, y-1 }, { x, y+1 } };
+      for (auto const& n: neighbours)
+      {
+        if (n[0] < 0 || n[0] >= size_ || n[1] < 0 || n[1] >= size_)
+          continue;
+        int const other = run_at_[n[0] + n[1] * size_];
+        if (other >= 0 && grid.at(n[0], n[1]) == shape)
+          join(int(r), other);
+      }
+    }
+  }
+
+  group_of_root_.assign(runs.size(), -1);
+  for (std::size_t r = 0; r < runs.size(); ++r)
+  {
+    Grid::Run const& run = runs[r];
+    int& g = group_of_root_[find_root(int(r))];
+    if (g < 0)
+    {
+      g = int(groups.size());
+      groups.push_back(MatchGroup{ grid.at(run.x, run.y), pattern_line3, Grid::CellList() });
+    }
+    for (int i = 0; i < run.length; ++i)
+    {
+      Vector2i const p(run.x + i * run.dx, run.y + i * run.dy);
+      int const cell = p.x + p.y * size_;
+      if (group_at_[cell] < 0)
+      {
+        group_at_[cell] = g;
+        groups[g].cells.push_back(p);
+      }
+    }
+  }
+
+  tag_patterns(groups);
+
+  for (auto const& group: groups)
+  {
+    for (auto const& p: group.cells)
+    {
+      run_at_[p.x + p.y * size_] = -1;
+      group_at_[p.x + p.y * size_] = -1;
+    }
+  }
+}
+
+
+int NoDice::PatternMatcher::
+find_root(int run)
+{
+  while (parents_[run] != run)
+  {
+    parents_[run] = parents_[parents_[run]];
+    run = parents_[run];
+  }
+  return run;
+}
+
+
+/**
+ * Each group's cells are laid out in turn as rows of bits in the one plane,
+ * and each mask is tested against all of them at once: a pattern fits at
+ * (x, y) when, for every cell of the mask, the row of bits shifted along by
+ * the cell's dx has bit x set.  Only the rows and words the group covers are
+ * scanned, and the group's bits are cleared again afterwards, so the work
+ * goes with the size of the groups rather than of the grid.
+ */
+void NoDice::PatternMatcher::
+tag_patterns(MatchGroupList& groups)
+{
+  int const row_words = words_per_row_;
+  for (auto& group: groups)
+  {
+    int min_x = size_, min_y = size_, max_x = -1, max_y = -1;
+    for (auto const& p: group.cells)
+    {
+      bits_[p.y * row_words + p.x / bits_per_word] |= Word(1) << (p.x % bits_per_word);
+      min_x = std::min(min_x, p.x);
+      min_y = std::min(min_y, p.y);
+      max_x = std::max(max_x, p.x);
+      max_y = std::max(max_y, p.y);
+    }
+    int const width = max_x - min_x + 1;
+    int const height = max_y - min_y + 1;
+
+    for (Mask const& mask: mask_table.masks)
+    {
+      if (mask.pattern <= group.pattern || mask.width > width || mask.height > height)
+        continue;
+      bool is_found = false;
+      for (int y = min_y; !is_found && y + mask.height <= max_y + 1; ++y)
+      {
+        for (int w = min_x / bits_per_word; w <= max_x / bits_per_word; ++w)
+        {
+          Word anchors = ~Word(0);
+          for (int dy = 0; dy < mask.height; ++dy)
+          {
+            Word const* row = &bits_[(y + dy) * row_words];
+            for (int dx = 0; dx < mask.width; ++dx)
+            {
+              if (mask.rows[dy] & (1u << dx))
+                anchors &= shifted(row, w, row_words, dx);
+            }
+          }
+          is_found = is_found || anchors != 0;
+        }
+      }
+      if (is_found)
+        group.pattern = mask.pattern;
+    }
+
+    for (auto const& p: group.cells)
+      bits_[p.y * row_words + p.x / bits_per_word] = 0;
+  }
+}
@@ -0,0 +1,117 @@
+/**
+ * @file nodice/pattern.h
+ * @brief Public interface of the nodice/pattern module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_PATTERN_H
+#define NODICE_PATTERN_H 1
+
+#include "nodice/grid.h"
+#include <cstdint>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * The shapes a match can make, from least to most worth.  A match is
+   * tagged with the most worthwhile pattern it holds.
+   */
+  enum Pattern
+  {
+    pattern_line3,
+    pattern_line4,
+    pattern_block,  ///< a 2x2 square, from two lines side by side
+    pattern_l,
+    pattern_t,
+    pattern_line5,
+    pattern_plus,
+    pattern_count
+  };
+
+  /** Gets a short name for a pattern. */
+  char const*
+  pattern_name(Pattern pattern);
+
+  /** Gets the bonus a match scores on top of its rolls for its pattern. */
+  int
+  pattern_bonus(Pattern pattern);
+
+  /** The cells of one shape that match together and the pattern they make. */
+  struct MatchGroup
+  {
+    ShapeId        shape;
+    Pattern        pattern;
+    Grid::CellList cells;
+  };
+
+  typedef std::vector<MatchGroup> MatchGroupList;
+
+  /**
+   * Merges the runs found on a grid into groups and works out what pattern
+   * each group makes.
+   *
+   * Runs of the same shape that cross or lie alongside each other make one
+   * group, so a cross is one match rather than two.  The patterns are drawn in
+   * a table as little pictures, which are turned into bit masks, one per
+   * orientation, when the program is compiled.  Each mask is tested against
+   * every cell of a group at once by shifting and ANDing whole rows
+   * of bits, the same way BitBoard finds runs.
+   */
+  class PatternMatcher
+  {
+  public:
+    /** Constructs a matcher for grids with @p size cells along each side. */
+    explicit
+    PatternMatcher(int size);
+
+    /**
+     * Groups the runs found on a grid.
+     * @param[in]  grid   the grid the runs were found on, before removing them
+     * @param[in]  runs   the runs
+     * @param[out] groups receives one group per set of touching runs of the
+     *                    same shape, in the order of their first runs
+     */
+    void
+    group(Grid const& grid, Grid::RunList const& runs, MatchGroupList& groups);
+
+  private:
+    typedef std::uint64_t Word;
+
+    int
+    find_root(int run);
+
+    void
+    tag_patterns(MatchGroupList& groups);
+
+  private:
+    int               size_;
+    int               words_per_row_;
+    std::vector<int>  run_at_;    ///< a run through each cell, or -1
+    std::vector<int>  group_at_;  ///< the group of each cell, or -1
+    std::vector<int>  parents_;   ///< the union-find forest of runs
+    std::vector<int>  group_of_root_;
+    std::vector<Word> bits_;      ///< the cells of one group, row by row
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_PATTERN_H
@@ -30,6 +30,7 @@
 #include "nodice/colour.h"
 #include "nodice/config.h"
 #include "nodice/font.h"
+#include "nodice/glstate.h"
 #include "nodice/object.h"
 #include "nodice/shape.h"
 #include "nodice/video.h"
@@ -48,6 +49,8 @@ namespace
   static const NoDice::Vector4f lightPosition(2.0f, 2.0f, 3.0f, 0.0f);
   static const NoDice::Vector3f lightDirection(-2.0f, -2.0f, -3.0f);
   static const int mouseMoveThreshold = 20;
+  static const NoDice::HintEngine::Budget hint_budget(250);
+  static const int hint_delay = 300;  // updates idle before showing a hint
 } // anonymous namespace
 
 
@@ -60,6 +63,9 @@ PlayState(App* app)
 , mouse_is_down_(false)
 , multiplier_(0)
 , score_(0)
+, hints_(app_->config().seed())
+, has_hint_(false)
+, idle_ticks_(0)
 {
   // generate unproject matrix
   glMatrixMode(GL_PROJECTION);
@@ -91,6 +97,8 @@ PlayState(App* app)
   glPopMatrix();
   glMatrixMode(GL_PROJECTION);
   glPopMatrix();
+
+  requestHint();
 }
 
 
@@ -100,10 +108,46 @@ NoDice::PlayState::
 }
 
 
+/**
+ * Pressing R turns the board a quarter turn clockwise, Z takes back the last
+ * turn and Y plays it again.  They are only allowed while the board is at
+ * rest, or once the game is over for Z and Y.
+ */
+void NoDice::PlayState::
+key(SDL_Keysym keysym)
+{
+  bool const is_at_rest = (state_ == state_idle || state_ == state_end) && !mouse_is_down_;
+  if (!is_at_rest)
+    return;
+
+  if (keysym.sym == SDLK_r && state_ == state_idle)
+  {
+    showHint(false);
+    hints_.cancel();
+    has_hint_ = false;
+    gameboard_.start_rotating();
+    state_ = state_rotating;
+  }
+  else if ((keysym.sym == SDLK_z && gameboard_.history().undo_count() > 0)
+        || (keysym.sym == SDLK_y && gameboard_.history().redo_count() > 0))
+  {
+    showHint(false);
+    if (keysym.sym == SDLK_z)
+      score_ -= gameboard_.undo();
+    else
+      score_ += gameboard_.redo();
+    win_messages_.clear();
+    state_ = state_idle;
+    requestHint();
+  }
+}
+
+
 void NoDice::PlayState::
 pointerMove(int x, int y, int dx, int dy)
 {
-  if (mouse_is_down_ && state_ != state_swapping)
+  if (mouse_is_down_ && state_ != state_swapping && state_ != state_rotating
+      && state_ != state_end)
   {
     Vector2i d = mouse_down_pos_ - Vector2i(x, y);
     if (d.lengthSquared() < mouseMoveThreshold * mouseMoveThreshold)
@@ -128,6 +172,8 @@ pointerMove(int x, int y, int dx, int dy)
       else
         return;
     }
+    hints_.cancel();
+    showHint(false);
     state_ = state_swapping;
     gameboard_.start_swap(selected_pos_, pos2);
   }
@@ -159,8 +205,8 @@ pointerClick(int x, int y, PointerAction action)
     if (selected_pos_.y >= app_->config().board_size() || selected_pos_.y < 0)
       return;
 
-    ObjectPtr obj = gameboard_.at(selected_pos_.x, selected_pos_.y);
-    obj->setHighlight(true);
+    Object& obj = gameboard_.at(selected_pos_.x, selected_pos_.y);
+    obj.setHighlight(true);
 
     mouse_is_down_ = true;
   }
@@ -170,11 +216,18 @@ pointerClick(int x, int y, PointerAction action)
 void NoDice::PlayState::
 calculateScore(const ObjectBrace& matches)
 {
+  int bonus = 0;
+  rolls_.clear();
   for (auto it = matches.begin(); it != matches.end(); ++it)
   {
-    int match_score = multiplier_;
+    Pattern const pattern = gameboard_.win_pattern(it - matches.begin());
+    int match_score = multiplier_ + pattern_bonus(pattern);
     std::ostringstream ostr;
-    ostr << it->size() << it->at(0)->type();
+    ostr << it->size() << shapeRegistry().name(it->at(0)->type());
+    if (pattern != pattern_line3)
+    {
+      ostr << " " << pattern_name(pattern);
+    }
     if (multiplier_)
     {
       ostr << "+" << multiplier_;
@@ -182,30 +235,95 @@ calculateScore(const ObjectBrace& matches)
     std::cerr << ostr.str() << "(";
     for (auto obj = it->begin(); obj != it->end(); ++obj)
     {
-      int score = (*obj)->score();
+      int score = (*obj)->score(gameboard_.random());
       std::cerr << " " << score;
       match_score += score;
+      rolls_.push_back(score);
     }
+    bonus += multiplier_ + pattern_bonus(pattern);
     std::cerr << " ) total=" << match_score << "\n";
     score_ += match_score;
     win_messages_.push_back(ostr.str());
   }
+  gameboard_.record_score(rolls_, bonus);
   state_ = state_replacing;
   ++multiplier_;
 }
 
 
+/**
+ * When the board settles with no move left on it the dice are shuffled, and
+ * if they cannot be laid out with a move the game is over.
+ */
+void NoDice::PlayState::
+checkForMoves()
+{
+  if (gameboard_.has_legal_move())
+    return;
+
+  if (gameboard_.reshuffle())
+  {
+    win_messages_.push_back("No moves: reshuffled");
+  }
+  else
+  {
+    win_messages_.push_back("No moves left");
+    state_ = state_end;
+  }
+}
+
+
+/**
+ * Starts the hint engine working on the board as it stands.  The hint is
+ * worked out on other threads and picked up by update() when it is ready.
+ */
+void NoDice::PlayState::
+requestHint()
+{
+  has_hint_ = false;
+  idle_ticks_ = 0;
+  hints_.request(gameboard_.grid(), hint_budget);
+}
+
+
+void NoDice::PlayState::
+showHint(bool toggle)
+{
+  if (has_hint_)
+  {
+    gameboard_.at(hint_.first.x, hint_.first.y).setHighlight(toggle);
+    gameboard_.at(hint_.second.x, hint_.second.y).setHighlight(toggle);
+  }
+}
+
+
 void NoDice::PlayState::
 update(App& app NODICE_UNUSED)
 {
+  Hint hint;
+  if (hints_.poll(hint))
+  {
+    hint_ = hint.move;
+    has_hint_ = true;
+  }
+
   gameboard_.update();
   switch (state_)
   {
+    case state_idle:
+    {
+      if (++idle_ticks_ >= hint_delay)
+      {
+        showHint(true);
+      }
+      break;
+    }
+
     case state_swapping:
     {
       if (!gameboard_.is_swapping())
       {
-        ObjectBrace matches(gameboard_.find_wins());
+        ObjectBrace const& matches = gameboard_.find_wins();
         if (matches.size())
         {
           calculateScore(matches);
@@ -225,6 +343,7 @@ update(App& app NODICE_UNUSED)
       if (!gameboard_.is_swapping())
       {
         state_ = state_idle; // temp. for now
+        requestHint();
       }
       break;
     }
@@ -233,7 +352,7 @@ update(App& app NODICE_UNUSED)
     {
       if (!gameboard_.is_replacing())
       {
-        ObjectBrace matches(gameboard_.find_wins());
+        ObjectBrace const& matches = gameboard_.find_wins();
         if (matches.size() > 0)
         {
           calculateScore(matches);
@@ -244,11 +363,25 @@ update(App& app NODICE_UNUSED)
           state_ = state_idle;
           multiplier_ = 0;
           win_messages_.clear();
+          checkForMoves();
+          gameboard_.end_move();
+          if (state_ == state_idle)
+            requestHint();
         }
       }
       break;
     }
 
+    case state_rotating:
+    {
+      if (!gameboard_.is_rotating())
+      {
+        state_ = state_idle;
+        requestHint();
+      }
+      break;
+    }
+
                 default:
                   break;
   }
@@ -277,25 +410,25 @@ draw(Video& video NODICE_UNUSED)
 #else
   glOrtho(-right, right, -top, top, near, far);
 #endif
-  glDisable(GL_DEPTH_TEST);
-  glEnable(GL_LIGHTING);
-  glEnable(GL_LIGHT0);
-  glEnable(GL_CULL_FACE);
-  glEnable(GL_COLOR_MATERIAL);
-  glEnable(GL_NORMALIZE);
-  glShadeModel(GL_SMOOTH);
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-
-  glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, white.rgba);
-  glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 60.0f);
-  glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmbient.rgba);
-  glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDiffuse.rgba);
-  glLightfv(GL_LIGHT0, GL_SPECULAR, white.rgba);
+  GlState& state = glState();
+  state.disable(GL_DEPTH_TEST);
+  state.enable(GL_LIGHTING);
+  state.enable(GL_LIGHT0);
+  state.enable(GL_COLOR_MATERIAL);
+  state.enable(GL_RESCALE_NORMAL);
+  state.shade_model(GL_SMOOTH);
+  state.enable(GL_BLEND);
+  state.blend_func(GL_SRC_ALPHA, GL_ONE);
+
+  state.material(GL_FRONT_AND_BACK, GL_SPECULAR, white.rgba);
+  state.material(GL_FRONT_AND_BACK, GL_SHININESS, 60.0f);
+  state.light(GL_LIGHT0, GL_AMBIENT, lightAmbient.rgba);
+  state.light(GL_LIGHT0, GL_DIFFUSE, lightDiffuse.rgba);
+  state.light(GL_LIGHT0, GL_SPECULAR, white.rgba);
   glLightfv(GL_LIGHT0, GL_POSITION, lightPosition.xyzw);
   glLightfv(GL_LIGHT0, GL_SPOT_DIRECTION, lightDirection.xyz);
-  glLightf(GL_LIGHT0, GL_SPOT_CUTOFF, 1.2f);
-  glLightf(GL_LIGHT0, GL_SPOT_EXPONENT, 20.0f);
+  state.light(GL_LIGHT0, GL_SPOT_CUTOFF, 1.2f);
+  state.light(GL_LIGHT0, GL_SPOT_EXPONENT, 20.0f);
 
   glMatrixMode(GL_MODELVIEW);
   glPushMatrix();
@@ -26,6 +26,7 @@
 #include "nodice/gamestate.h"
 
 #include "nodice/board.h"
+#include "nodice/hint.h"
 #include "nodice/maths.h"
 #include <string>
 #include <vector>
@@ -42,6 +43,7 @@ namespace NoDice
     PlayState(App* app);
     ~PlayState();
 
+    void key(SDL_Keysym keysym);
     void pointerMove(int x, int y, int dx, int dy);
     void pointerClick(int x, int y, PointerAction action);
 
@@ -50,6 +52,9 @@ namespace NoDice
 
   private:
     void calculateScore(const ObjectBrace& matches);
+    void checkForMoves();
+    void requestHint();
+    void showHint(bool toggle);
 
   private:
     enum SubState
@@ -71,6 +76,11 @@ namespace NoDice
     int                       multiplier_;
     int                       score_;
     std::vector<std::string>  win_messages_;
+    std::vector<int>          rolls_;
+    HintEngine                hints_;
+    Grid::Move                hint_;
+    bool                      has_hint_;
+    int                       idle_ticks_;
     Matrix4f                  unproject_;
   };
 
@@ -0,0 +1,189 @@
+/**
+ * @file nodice/pool.h
+ * @brief Public interface of the nodice/pool module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_POOL_H
+#define NODICE_POOL_H 1
+
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * A fixed number of slots for objects of type T, allocated once up front.
+   *
+   * Objects are made in a free slot and named by a small handle, the slot's
+   * index.  Destroying an object puts its slot back on the free list for the
+   * next one to reuse, so making and destroying objects never calls the
+   * allocator and handles can be copied around without any reference counts.
+   *
+   * A handle is only good until its object is destroyed.
+   */
+  template<typename T>
+  class Pool
+  {
+  public:
+    typedef std::uint32_t Handle;
+
+    /** A handle that never names an object. */
+    static const Handle no_handle = ~Handle(0);
+
+  public:
+    /** Constructs a pool with room for @p capacity objects. */
+    explicit
+    Pool(std::size_t capacity);
+
+    /** Destroys any objects still in the pool. */
+    ~Pool();
+
+    /** Gets the number of objects the pool can hold. */
+    std::size_t
+    capacity() const;
+
+    /** Gets the number of objects in the pool. */
+    std::size_t
+    size() const;
+
+    /**
+     * Makes an object in a free slot.
+     * @param[in] args the arguments to pass to T's constructor
+     * @returns the handle of the new object
+     * @throws std::runtime_error if every slot is in use
+     */
+    template<typename... Args>
+    Handle
+    create(Args&&... args);
+
+    /** Destroys an object and frees its slot. */
+    void
+    destroy(Handle handle);
+
+    /** Gets the object named by a handle. */
+    T&
+    operator[](Handle handle);
+
+    /** Gets the object named by a handle. */
+    T const&
+    operator[](Handle handle) const;
+
+  private:
+    Pool(Pool const&) = delete;
+    Pool& operator=(Pool const&) = delete;
+
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Slot;
+
+  private:
+    std::vector<Slot>   slots_;
+    std::vector<bool>   is_live_;
+    std::vector<Handle> free_;
+  };
+
+
+  template<typename T>
+  const typename Pool<T>::Handle Pool<T>::no_handle;
+
+
+  /**
+   * The free list is a stack holding the highest slot at the bottom, so slots
+   * are handed out from the front of the pool first.
+   */
+  template<typename T>
+  Pool<T>::
+  Pool(std::size_t capacity)
+  : slots_(capacity)
+  , is_live_(capacity, false)
+  {
+    free_.reserve(capacity);
+    for (std::size_t i = capacity; i > 0; --i)
+      free_.push_back(Handle(i - 1));
+  }
+
+
+  template<typename T>
+  Pool<T>::
+  ~Pool()
+  {
+    for (std::size_t i = 0; i < slots_.size(); ++i)
+    {
+      if (is_live_[i])
+        (*this)[Handle(i)].~T();
+    }
+  }
+
+
+  template<typename T>
+  std::size_t Pool<T>::
+  capacity() const
+  { return slots_.size(); }
+
+
+  template<typename T>
+  std::size_t Pool<T>::
+  size() const
+  { return slots_.size() - free_.size(); }
+
+
+  template<typename T>
+  template<typename... Args>
+  typename Pool<T>::Handle Pool<T>::
+  create(Args&&... args)
+  {
+    if (free_.empty())
+      throw std::runtime_error("object pool is full");
+    Handle const handle = free_.back();
+    new (&slots_[handle]) T(std::forward<Args>(args)...);
+    free_.pop_back();
+    is_live_[handle] = true;
+    return handle;
+  }
+
+
+  template<typename T>
+  void Pool<T>::
+  destroy(Handle handle)
+  {
+    (*this)[handle].~T();
+    is_live_[handle] = false;
+    free_.push_back(handle);
+  }
+
+
+  template<typename T>
+  T& Pool<T>::
+  operator[](Handle handle)
+  { return *reinterpret_cast<T*>(&slots_[handle]); }
+
+
+  template<typename T>
+  T const& Pool<T>::
+  operator[](Handle handle) const
+  { return *reinterpret_cast<T const*>(&slots_[handle]); }
+
+} // namespace NoDice
+
+#endif // NODICE_POOL_H
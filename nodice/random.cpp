@@ -0,0 +1,49 @@
+/**
+ * @file nodice/random.cpp
+ * @brief Implemntation of the nodice/random module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/random.h"
+
+
+NoDice::Random::
+Random(result_type seed)
+{
+  this->seed(seed);
+}
+
+
+/**
+ * The seed is spread over the whole state with splitmix64, so nearby seeds
+ * (like a run of game numbers) still give unrelated streams and the state is
+ * never all zero.
+ */
+void NoDice::Random::
+seed(result_type seed)
+{
+  for (auto& s: state_)
+  {
+    seed += 0x9e3779b97f4a7c15ull;
+    result_type z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    s = z ^ (z >> 31);
+  }
+}
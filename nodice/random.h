@@ -0,0 +1,102 @@
+/**
+ * @file nodice/random.h
+ * @brief Public interface of the nodice/random module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_RANDOM_H
+#define NODICE_RANDOM_H 1
+
+#include <cstdint>
+
+
+namespace NoDice
+{
+  /**
+   * A fast, seedable source of random numbers (xoshiro256**).
+   *
+   * Each board has its own, so games can be played on different threads
+   * without sharing any state and any game can be played again exactly from
+   * its seed.  It meets the requirements of a uniform random bit generator so
+   * it can also be used with the <random> distributions.
+   */
+  class Random
+  {
+  public:
+    typedef std::uint64_t result_type;
+
+  public:
+    /** Constructs a generator from a seed. */
+    explicit
+    Random(result_type seed = 0);
+
+    /** Restarts the generator from a seed. */
+    void
+    seed(result_type seed);
+
+    /** Gets the next random number. */
+    result_type
+    operator()();
+
+    /** Gets a random number in [0, n). */
+    int
+    below(int n);
+
+    static constexpr result_type
+    min()
+    { return 0; }
+
+    static constexpr result_type
+    max()
+    { return ~result_type(0); }
+
+  private:
+    result_type state_[4];
+  };
+
+
+  inline Random::result_type Random::
+  operator()()
+  {
+    result_type const s1 = state_[1] * 5;
+    result_type const result = ((s1 << 7) | (s1 >> 57)) * 9;
+    result_type const t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = (state_[3] << 45) | (state_[3] >> 19);
+    return result;
+  }
+
+
+  /**
+   * Scales the top 32 bits into range with a multiply rather than a divide.
+   * The bias this leaves is at most n in 2^32, far too small to matter here.
+   */
+  inline int Random::
+  below(int n)
+  {
+    return int(((*this)() >> 32) * std::uint64_t(n) >> 32);
+  }
+
+} // namespace NoDice
+
+#endif // NODICE_RANDOM_H
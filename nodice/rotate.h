@@ -0,0 +1,71 @@
+/**
+ * @file nodice/rotate.h
+ * @brief Public interface of the nodice/rotate module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_ROTATE_H
+#define NODICE_ROTATE_H 1
+
+#include <algorithm>
+
+
+namespace NoDice
+{
+
+  /**
+   * Copies a square of cells turned a quarter turn clockwise, with y going
+   * up: the cell at (x, y) ends up at (y, size - 1 - x).
+   * @param[in]  from the cells, a row at a time from y = 0
+   * @param[out] to   receives the turned cells, and must not overlap @p from
+   * @param[in]  size the number of cells along each side
+   *
+   * A row read from @p from is a column written to @p to, so on a big square
+   * copying a row at a time touches a new cache line for every cell written.
+   * Instead the square is copied a tile at a time, and each tile's rows and
+   * columns stay in the cache until the tile is done.
+   */
+  template<typename T>
+  void
+  rotate_clockwise(T const* __restrict__ from, T* __restrict__ to, int size);
+
+
+  template<typename T>
+  void
+  rotate_clockwise(T const* __restrict__ from, T* __restrict__ to, int size)
+  {
+    static const int tile_size = 16;
+    for (int ty = 0; ty < size; ty += tile_size)
+    {
+      int const y_end = std::min(ty + tile_size, size);
+      for (int tx = 0; tx < size; tx += tile_size)
+      {
+        int const x_end = std::min(tx + tile_size, size);
+        for (int y = ty; y < y_end; ++y)
+        {
+          for (int x = tx; x < x_end; ++x)
+            to[y + (size - 1 - x) * size] = from[x + y * size];
+        }
+      }
+    }
+  }
+
+} // namespace NoDice
+
+#endif // NODICE_ROTATE_H
@@ -20,6 +20,7 @@
 #include "nodice/shape.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cstdlib>
 #include <iostream>
 #include "nodice/d4.h"
@@ -27,33 +28,18 @@
 #include "nodice/d8.h"
 #include "nodice/d12.h"
 #include "nodice/d20.h"
+#include "nodice/meshbuilder.h"
 #include <vector>
 
-namespace
-{
-	typedef std::vector<NoDice::ShapePtr> ShapeBag;
-
-	ShapeBag
-	generateShapeBag()
-	{
-		ShapeBag bag;
-
-		bag.push_back(NoDice::ShapePtr(new NoDice::D4));
-		bag.push_back(NoDice::ShapePtr(new NoDice::D6)); 
-		bag.push_back(NoDice::ShapePtr(new NoDice::D8)); 
-		bag.push_back(NoDice::ShapePtr(new NoDice::D12)); 
-		bag.push_back(NoDice::ShapePtr(new NoDice::D20)); 
-
-		return bag;
-	}
-} // anonymous namespace
-
 
 NoDice::Shape::
-Shape(const std::string& name,
+Shape(ShapeId            die,
+      const std::string& name,
 			const Colour&      defaultColour)
-: m_name(name)
+: m_die(die)
+, m_name(name)
 , m_defaultColour(defaultColour)
+, m_mesh{ 0, 0, 0, 0 }
 {
 }
 
@@ -78,22 +64,98 @@ defaultColour() const
 }
 
 
+NoDice::ShapeId NoDice::Shape::
+die() const
+{
+  return m_die;
+}
+
+
 int NoDice::Shape::
-score()
+score(Random& random) const
 {
-  return 0;
+  return roll_die(m_die, random);
 }
 
 
-NoDice::ShapePtr NoDice::
-chooseAShape()
+const NoDice::MeshArena::Range& NoDice::Shape::
+mesh() const
 {
-	static ShapeBag s_shapeBag = generateShapeBag();
+  return m_mesh;
+}
 
-	int r = (rand() >> 2) % s_shapeBag.size();
-	return s_shapeBag.at(r);
+
+void NoDice::Shape::
+setMesh(const GLfloat* rows, GLsizei vertexCount)
+{
+  MeshBuilder builder;
+  builder.add_triangles(rows, vertexCount);
+  builder.optimize();
+  m_mesh = meshArena().add(builder);
 }
 
+
+NoDice::ShapeId NoDice::ShapeRegistry::
+add(const ShapePtr& shape)
+{
+  m_shapes.push_back(shape);
+  return ShapeId(m_shapes.size() - 1);
+}
+
+
+int NoDice::ShapeRegistry::
+size() const
+{
+  return m_shapes.size();
+}
+
+
+NoDice::Shape& NoDice::ShapeRegistry::
+get(ShapeId id) const
+{
+  return *m_shapes[id];
+}
+
+
+const std::string& NoDice::ShapeRegistry::
+name(ShapeId id) const
+{
+  return m_shapes[id]->name();
+}
+
+
+NoDice::ShapeId NoDice::ShapeRegistry::
+find(const std::string& name) const
+{
+  for (std::size_t i = 0; i < m_shapes.size(); ++i)
+  {
+    if (m_shapes[i]->name() == name)
+      return ShapeId(i);
+  }
+  return no_shape;
+}
+
+
+NoDice::ShapeRegistry& NoDice::
+shapeRegistry()
+{
+  static ShapeRegistry s_registry = []
+  {
+    ShapeRegistry registry;
+    registry.add(ShapePtr(new D4));
+    registry.add(ShapePtr(new D6));
+    registry.add(ShapePtr(new D8));
+    registry.add(ShapePtr(new D12));
+    registry.add(ShapePtr(new D20));
+    for (ShapeId id = 0; id < registry.size(); ++id)
+      assert(registry.get(id).die() == id);
+    assert(registry.size() == die_count);
+    return registry;
+  }();
+  return s_registry;
+}
+
+
 /**
  * Generates the VBO entries for a triangle.
  * @param[in]  vertex Array of vertexes 
@@ -21,10 +21,14 @@
 #define NODICE_SHAPE_H 1
 
 #include "nodice/colour.h"
+#include "nodice/dice.h"
 #include <string>
 #include <memory>
 #include "nodice/maths.h"
+#include "nodice/mesharena.h"
+#include "nodice/random.h"
 #include "nodice/video.h"
+#include <vector>
 
 
 namespace NoDice
@@ -35,8 +39,9 @@ namespace NoDice
   class Shape
   {
   public:
-    /** Constructs a shape base object. */
-    Shape(const std::string& name,
+    /** Constructs a shape base object for one of the dice in nodice/dice.h. */
+    Shape(ShapeId            die,
+          const std::string& name,
     			const Colour&      defaultColour);
 
     /** Destroys a shape. */
@@ -48,22 +53,66 @@ namespace NoDice
     /** Gets the default colour for the shape. */
     const Colour& defaultColour() const;
 
-    /** Gives the base score for the shape. */
-    virtual int score();
+    /** Gets which of the dice in nodice/dice.h the shape is. */
+    ShapeId die() const;
 
-    /** Renders the shape. */
-    virtual void draw() const = 0;
+    /** Gives the base score for the shape, a roll of its die. */
+    int score(Random& random) const;
+
+    /** Gets where the shape's triangles are in the mesh arena. */
+    const MeshArena::Range& mesh() const;
+
+  protected:
+    /**
+     * Puts the shape's triangles in the mesh arena.  The triangles are given as
+     * rows of a vertex and a normal, three rows to a triangle, and are welded
+     * into indexed triangles ordered for the vertex cache on the way in.
+     */
+    void setMesh(const GLfloat* rows, GLsizei vertexCount);
 
   private:
-    std::string  m_name;
-		Colour       m_defaultColour;
+    ShapeId              m_die;
+    std::string          m_name;
+		Colour               m_defaultColour;
+    MeshArena::Range     m_mesh;
   };
 
   /** Points to a shape. */
   typedef std::shared_ptr<Shape> ShapePtr;
 
-  /** Randomly chooses a shape from its bag. */
-  ShapePtr chooseAShape();
+  /**
+   * The shapes in play, each known by a small ID counting up from 0 in the
+   * order they were added.  Game code compares and indexes by ID; the shapes
+   * themselves are only needed to draw them or to show their names.
+   */
+  class ShapeRegistry
+  {
+  public:
+    /** Adds a shape and gives it the next ID. */
+    ShapeId add(const ShapePtr& shape);
+
+    /** Gets the number of shapes registered. */
+    int size() const;
+
+    /** Gets a shape by its ID. */
+    Shape& get(ShapeId id) const;
+
+    /** Gets the name of a shape by its ID. */
+    const std::string& name(ShapeId id) const;
+
+    /** Finds the ID of the shape with a given name, or no_shape if none. */
+    ShapeId find(const std::string& name) const;
+
+  private:
+    std::vector<ShapePtr> m_shapes;
+  };
+
+  /**
+   * Gets the registry of dice, filled when it is first used, which is safe to
+   * do from any thread.  The IDs are in the same order as the dice in
+   * nodice/dice.h.
+   */
+  ShapeRegistry& shapeRegistry();
 
   /** Generates a triangle. */
   void triangle(const Vector3f vertexes[],
@@ -0,0 +1,248 @@
+/**
+ * @file nodice/sim.cpp
+ * @brief Implemntation of the no-dice batch game simulator mainline.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice_config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include "nodice/cascade.h"
+#include "nodice/dice.h"
+#include "nodice/grid.h"
+#include "nodice/threadpool.h"
+#include <vector>
+
+
+namespace
+{
+  /** What to simulate. */
+  struct Options
+  {
+    int      game_count  = 1000;
+    unsigned threads     = 0;
+    int      board_size  = 8;
+    int      max_moves   = 1000;
+    std::uint64_t seed   = std::uint64_t(std::time(NULL));
+  };
+
+  /** What happened in one game. */
+  struct GameResult
+  {
+    int  score;
+    int  moves;
+    bool is_stuck;
+  };
+
+  /** Cascade depths seen by one worker: depth_counts[n] moves cascaded n steps. */
+  typedef std::vector<std::int64_t> DepthCounts;
+
+  void
+  usage(char const* name)
+  {
+    std::cerr << "usage: " << name << " [-n games] [-j threads] [-s board-size]"
+                                      " [-m max-moves] [-r seed]\n";
+  }
+
+  bool
+  parse_options(int argc, char* argv[], Options& options)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      if (argv[i][0] != '-' || std::strlen(argv[i]) != 2 || i + 1 >= argc)
+        return false;
+      char const* const arg = argv[++i];
+      int const value = std::atoi(arg);
+      char* end = NULL;
+      switch (argv[i-1][1])
+      {
+        case 'n': options.game_count = value;          break;
+        case 'j': options.threads    = unsigned(value); break;
+        case 's': options.board_size = value;          break;
+        case 'm': options.max_moves  = value;          break;
+        case 'r':
+          options.seed = std::strtoull(arg, &end, 0);
+          if (end == arg || *end != '\0')
+            return false;
+          break;
+        default:  return false;
+      }
+    }
+    return options.game_count > 0 && options.board_size >= 3 && options.max_moves > 0;
+  }
+
+  /**
+   * Plays one game, choosing a random winning swap each move, until there are
+   * no winning swaps left or the move limit is reached.
+   */
+  GameResult
+  play_game(NoDice::Grid& grid, std::uint64_t seed, int max_moves,
+            DepthCounts& depth_counts)
+  {
+    NoDice::MoveResult       result;
+    NoDice::Grid::MoveList   swaps;
+    GameResult               game{ 0, 0, false };
+
+    grid.random().seed(seed);
+    grid.generate();
+    while (game.moves < max_moves)
+    {
+      grid.find_winning_swaps(swaps);
+      if (swaps.empty())
+      {
+        game.is_stuck = true;
+        break;
+      }
+      auto const& swap = swaps[grid.random().below(swaps.size())];
+      NoDice::resolve_move(grid, swap.first, swap.second, result);
+      game.score += result.score;
+      ++game.moves;
+
+      std::size_t const depth = result.steps.size();
+      if (depth >= depth_counts.size())
+        depth_counts.resize(depth + 1, 0);
+      ++depth_counts[depth];
+    }
+    return game;
+  }
+
+  /** Gets the value below which a fraction @p p of the sorted values lie. */
+  int
+  percentile(std::vector<int> const& sorted, double p)
+  {
+    return sorted[std::size_t(p * (sorted.size() - 1))];
+  }
+
+  void
+  report_distribution(char const* name, std::vector<int> values)
+  {
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (int v: values)
+      sum += v;
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed
+              << std::setprecision(1)
+              << " mean " << sum / values.size()
+              << "  min " << values.front()
+              << "  p10 " << percentile(values, 0.10)
+              << "  p50 " << percentile(values, 0.50)
+              << "  p90 " << percentile(values, 0.90)
+              << "  max " << values.back() << "\n";
+  }
+
+  void
+  report_histogram(char const* name, std::vector<int> const& values, int bins)
+  {
+    auto const range = std::minmax_element(values.begin(), values.end());
+    int const bottom = *range.first;
+    int const width = std::max(1, (*range.second - bottom + bins) / bins);
+    std::vector<int> counts((*range.second - bottom) / width + 1, 0);
+    for (int v: values)
+      ++counts[(v - bottom) / width];
+
+    std::cout << name << " histogram:\n";
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+      std::cout << std::setw(8) << bottom + i * width << "-" << std::left
+                << std::setw(8) << bottom + (i + 1) * width - 1 << std::right
+                << std::setw(10) << counts[i] << "\n";
+    }
+  }
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parse_options(argc, argv, options))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  NoDice::ThreadPool pool(options.threads);
+  int const workers = std::min<int>(options.game_count, pool.size());
+  std::vector<GameResult>  games(options.game_count);
+  std::vector<DepthCounts> depth_counts(workers);
+  std::atomic<int>         next_game(0);
+
+  // Each worker has its own grid and its own counts and takes the next game
+  // whenever it finishes one, so a run of long games does not hold up the
+  // rest.  Each game is seeded from its number, so the results do not depend
+  // on which worker played it.
+  auto const start = std::chrono::steady_clock::now();
+  pool.parallel_for(workers, [&](int w)
+  {
+    NoDice::Grid grid(options.board_size, NoDice::die_count, options.seed);
+    for (int g = next_game++; g < options.game_count; g = next_game++)
+    {
+      games[g] = play_game(grid, options.seed + g, options.max_moves,
+                           depth_counts[w]);
+    }
+  });
+  std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now()
+                                              - start;
+
+  std::vector<int> scores;
+  std::vector<int> moves;
+  int stuck_count = 0;
+  for (auto const& game: games)
+  {
+    scores.push_back(game.score);
+    moves.push_back(game.moves);
+    stuck_count += game.is_stuck;
+  }
+  DepthCounts depths;
+  for (auto const& counts: depth_counts)
+  {
+    if (counts.size() > depths.size())
+      depths.resize(counts.size(), 0);
+    for (std::size_t i = 0; i < counts.size(); ++i)
+      depths[i] += counts[i];
+  }
+
+  std::cout << PACKAGE_STRING << " simulator\n"
+            << "games    " << options.game_count
+            << " on a " << options.board_size << "x" << options.board_size
+            << " board, seed " << options.seed << "\n"
+            << "threads  " << pool.size() << ", " << std::fixed
+            << std::setprecision(3) << elapsed.count() << " s, "
+            << std::setprecision(1) << options.game_count / elapsed.count()
+            << " games/s\n"
+            << "ended    " << stuck_count << " with no move left, "
+            << options.game_count - stuck_count << " at the "
+            << options.max_moves << " move limit\n";
+  report_distribution("score", scores);
+  report_distribution("moves", moves);
+  report_histogram("score", scores, 20);
+  std::cout << "cascade depth histogram:\n";
+  for (std::size_t i = 1; i < depths.size(); ++i)
+  {
+    std::cout << std::setw(8) << i << std::setw(10) << depths[i] << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file nodice/solve.cpp
+ * @brief Implemntation of the no-dice puzzle solver mainline.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice_config.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "nodice/dice.h"
+#include "nodice/grid.h"
+#include "nodice/solver.h"
+#include "nodice/threadpool.h"
+#include <vector>
+
+
+/*
+ * A puzzle file looks like this:
+ *
+ *   # anything after a hash is a comment
+ *   moves 6
+ *   refills 0123401234012340
+ *   01234
+ *   12340
+ *   03401
+ *   30012
+ *   40123
+ *
+ * The rows of the grid are given top row first, one digit per shape, and the
+ * refills are drawn in order as shapes are needed.
+ */
+namespace
+{
+  /** A puzzle as read from a file. */
+  struct Puzzle
+  {
+    int                          max_moves = 0;
+    std::vector<NoDice::ShapeId> refills;
+    std::vector<std::string>     rows;
+  };
+
+  void
+  usage(char const* name)
+  {
+    std::cerr << "usage: " << name << " [-j threads] puzzle-file\n";
+  }
+
+  bool
+  is_shape(char c)
+  {
+    return c >= '0' && c < '0' + NoDice::die_count;
+  }
+
+  bool
+  read_puzzle(std::istream& in, Puzzle& puzzle)
+  {
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line))
+    {
+      ++line_number;
+      line = line.substr(0, line.find('#'));
+      std::istringstream words(line);
+      std::string word;
+      if (!(words >> word))
+        continue;
+
+      if (word == "moves")
+      {
+        words >> puzzle.max_moves;
+      }
+      else if (word == "refills")
+      {
+        std::string shapes;
+        words >> shapes;
+        for (char c: shapes)
+        {
+          if (!is_shape(c))
+          {
+            std::cerr << "line " << line_number << ": not a shape: '" << c << "'\n";
+            return false;
+          }
+          puzzle.refills.push_back(NoDice::ShapeId(c - '0'));
+        }
+      }
+      else
+      {
+        for (char c: word)
+        {
+          if (!is_shape(c))
+          {
+            std::cerr << "line " << line_number << ": not a row: '" << word << "'\n";
+            return false;
+          }
+        }
+        puzzle.rows.push_back(word);
+      }
+    }
+
+    for (auto const& row: puzzle.rows)
+    {
+      if (row.size() != puzzle.rows.size())
+      {
+        std::cerr << "the grid is not square\n";
+        return false;
+      }
+    }
+    return puzzle.rows.size() >= 3 && puzzle.max_moves > 0;
+  }
+} // anonymous namespace
+
+
+int main(int argc, char* argv[])
+{
+  unsigned threads = 0;
+  int arg = 1;
+  if (arg + 1 < argc && std::strcmp(argv[arg], "-j") == 0)
+  {
+    threads = unsigned(std::atoi(argv[arg + 1]));
+    arg += 2;
+  }
+  if (arg + 1 != argc)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::ifstream in(argv[arg]);
+  Puzzle puzzle;
+  if (!in || !read_puzzle(in, puzzle))
+  {
+    std::cerr << argv[arg] << ": not a puzzle\n";
+    return 1;
+  }
+
+  int const size = int(puzzle.rows.size());
+  NoDice::Grid grid(size, NoDice::die_count, 0);
+  for (int i = 0; i < size; ++i)
+  {
+    for (int x = 0; x < size; ++x)
+      grid.set(x, size - i - 1, NoDice::ShapeId(puzzle.rows[i][x] - '0'));
+  }
+  NoDice::Grid::RunList runs;
+  grid.find_matches(runs);
+  if (!runs.empty())
+  {
+    std::cerr << argv[arg] << ": the grid starts with a match on it\n";
+    return 1;
+  }
+  grid.set_refills(puzzle.refills.data(), puzzle.refills.size());
+
+  NoDice::ThreadPool pool(threads);
+  NoDice::PuzzleSolver solver(&pool);
+  auto const start = std::chrono::steady_clock::now();
+  NoDice::PuzzleSolver::Solution const solution = solver.solve(grid, puzzle.max_moves);
+  std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now()
+                                              - start;
+
+  std::cout << PACKAGE_STRING << " puzzle solver\n";
+  for (auto const& move: solution.moves)
+  {
+    std::cout << "move " << move.first.x << " " << move.first.y
+              << " " << move.second.x << " " << move.second.y << "\n";
+  }
+  std::cout << "score " << std::fixed << std::setprecision(1) << solution.score
+            << " in " << solution.moves.size() << " of " << puzzle.max_moves
+            << " moves\n"
+            << "searched " << solver.positions_searched() << " positions in "
+            << std::setprecision(3) << elapsed.count() << " s on "
+            << pool.size() << " threads\n";
+  return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file nodice/solver.cpp
+ * @brief Implemntation of the nodice/solver module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/solver.h"
+
+#include <algorithm>
+#include <cstring>
+#include "nodice/dice.h"
+#include "nodice/threadpool.h"
+
+
+namespace
+{
+  /**
+   * Gets the table key for a position: the grid's hash mixed with how far
+   * down the refill list it is and how many moves are left.
+   */
+  NoDice::TranspositionTable::Key
+  position_key(NoDice::Grid const& grid, int moves_left)
+  {
+    std::uint64_t z = (std::uint64_t(grid.refills_used()) << 8 | moves_left)
+                    + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return grid.hash() ^ z ^ (z >> 31);
+  }
+
+  /**
+   * Packs a position's best score and the number of its best move in the
+   * order Grid::find_winning_swaps() gives them into one table value.  Scores
+   * are sums of half points, so a float holds them exactly.
+   */
+  NoDice::TranspositionTable::Value
+  pack(double score, int move)
+  {
+    float const narrow = float(score);
+    std::uint32_t bits;
+    std::memcpy(&bits, &narrow, sizeof(bits));
+    return NoDice::TranspositionTable::Value(std::uint32_t(move)) << 32 | bits;
+  }
+
+  double
+  unpack_score(NoDice::TranspositionTable::Value value)
+  {
+    std::uint32_t const bits = std::uint32_t(value);
+    float score;
+    std::memcpy(&score, &bits, sizeof(score));
+    return score;
+  }
+
+  int
+  unpack_move(NoDice::TranspositionTable::Value value)
+  {
+    return int(value >> 32);
+  }
+} // anonymous namespace
+
+
+NoDice::PuzzleSolver::Scratch::
+Scratch(Grid const& grid, int max_moves)
+: grids(max_moves + 1, grid)
+, moves(max_moves + 1)
+, seen(max_moves + 1)
+, best_moves(max_moves + 1, 0)
+{ }
+
+
+NoDice::PuzzleSolver::
+PuzzleSolver(ThreadPool* pool, std::size_t table_size)
+: pool_(pool)
+, table_(table_size)
+, positions_searched_(0)
+{ }
+
+
+/**
+ * The moves from the starting position each get a search of their own, in
+ * parallel if there is a pool.  The best series is then read back one move at
+ * a time from the best move the search of each position left behind, which
+ * comes straight from the table unless its entry has since been replaced.
+ */
+NoDice::PuzzleSolver::Solution NoDice::PuzzleSolver::
+solve(Grid const& grid, int max_moves)
+{
+  Solution solution{ Grid::MoveList(), 0.0 };
+  if (max_moves < 1)
+    return solution;
+
+  Grid start(grid);
+  start.set_thread_pool(NULL);
+  Grid::MoveList first_moves;
+  start.find_winning_swaps(first_moves);
+  auto const search_first = [&](int i)
+  {
+    Scratch scratch(start, max_moves);
+    Grid& next = scratch.grids[max_moves];
+    play(start, first_moves[i], next, scratch.result);
+    search(next, max_moves - 1, scratch);
+  };
+  if (pool_ && first_moves.size() > 1)
+    pool_->parallel_for(int(first_moves.size()), search_first);
+  else
+  {
+    for (int i = 0; i < int(first_moves.size()); ++i)
+      search_first(i);
+  }
+
+  Scratch scratch(start, max_moves);
+  Grid position(start);
+  Grid next(start);
+  Grid::MoveList moves;
+  for (int moves_left = max_moves; moves_left > 0; --moves_left)
+  {
+    if (search(position, moves_left, scratch) == 0.0)
+      break;
+    position.find_winning_swaps(moves);
+    int const best_move = scratch.best_moves[moves_left];
+    if (best_move >= int(moves.size()))
+      break;
+    solution.moves.push_back(moves[best_move]);
+    solution.score += play(position, moves[best_move], next, scratch.result);
+    position = next;
+  }
+  return solution;
+}
+
+
+std::uint64_t NoDice::PuzzleSolver::
+positions_searched() const
+{
+  return positions_searched_;
+}
+
+
+double NoDice::PuzzleSolver::
+expected_score(MoveResult const& result)
+{
+  double score = 0.0;
+  for (std::size_t step = 0; step < result.steps.size(); ++step)
+  {
+    for (auto const& match: result.steps[step].matches)
+      score += step + pattern_bonus(match.pattern)
+             + match.cells.size() * (die_faces(match.shape) + 1) / 2.0;
+  }
+  return score;
+}
+
+
+/**
+ * Gets the best score to be had from a position and leaves the number of the
+ * move that makes it in the scratch best moves.  Two moves that lead to the
+ * same position, like the same pair of shapes swapped either side of a line
+ * of its own kind, are only searched the first time.
+ */
+double NoDice::PuzzleSolver::
+search(Grid const& grid, int moves_left, Scratch& scratch)
+{
+  if (moves_left == 0)
+    return 0.0;
+  TranspositionTable::Key const key = position_key(grid, moves_left);
+  TranspositionTable::Value value;
+  if (table_.find(key, value))
+  {
+    scratch.best_moves[moves_left] = unpack_move(value);
+    return unpack_score(value);
+  }
+  ++positions_searched_;
+
+  Grid::MoveList& moves = scratch.moves[moves_left];
+  std::vector<TranspositionTable::Key>& seen = scratch.seen[moves_left];
+  Grid& next = scratch.grids[moves_left - 1];
+  grid.find_winning_swaps(moves);
+  seen.clear();
+  double best = 0.0;
+  int best_move = 0;
+  for (int i = 0; i < int(moves.size()); ++i)
+  {
+    double const score = play(grid, moves[i], next, scratch.result);
+    TranspositionTable::Key const next_key = position_key(next, moves_left - 1)
+                                           ^ pack(score, 0);
+    if (std::find(seen.begin(), seen.end(), next_key) != seen.end())
+      continue;
+    seen.push_back(next_key);
+    double const total = score + search(next, moves_left - 1, scratch);
+    if (total > best)
+    {
+      best = total;
+      best_move = i;
+    }
+  }
+  scratch.best_moves[moves_left] = best_move;
+  table_.store(key, pack(best, best_move));
+  return best;
+}
+
+
+/** Makes a move on a copy of a grid and plays it out. */
+double NoDice::PuzzleSolver::
+play(Grid const& grid, Grid::Move const& move, Grid& next, MoveResult& result)
+{
+  next = grid;
+  resolve_move(next, move.first, move.second, result);
+  return expected_score(result);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file nodice/solver.h
+ * @brief Public interface of the nodice/solver module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_SOLVER_H
+#define NODICE_SOLVER_H 1
+
+#include <atomic>
+#include <cstdint>
+#include "nodice/cascade.h"
+#include "nodice/grid.h"
+#include "nodice/transposition.h"
+#include <vector>
+
+
+namespace NoDice
+{
+  class ThreadPool;
+
+  /**
+   * Finds the best series of moves for a puzzle.
+   *
+   * A puzzle is a grid whose refills come from a fixed list (see
+   * Grid::set_refills()), so the only luck left is the roll of the dice.  The
+   * solver scores each match with the average roll of its dice, so the score
+   * of a series of moves is known exactly, and tries every series of winning
+   * moves up to the move limit.
+   *
+   * The best score from a position with a given number of moves left, and the
+   * move that makes it, is kept in a transposition table under the grid's
+   * hash, the number of refills used and the number of moves left, so a
+   * position reached by two routes is only searched once.  The moves from the starting position are searched in
+   * parallel on a thread pool, if there is one, sharing the table.
+   */
+  class PuzzleSolver
+  {
+  public:
+    /** The best series of moves and its score. */
+    struct Solution
+    {
+      Grid::MoveList moves;
+      double         score;
+    };
+
+  public:
+    /**
+     * Constructs a solver.
+     * @param[in] pool       the threads to search with, or NULL to search on
+     *                       the calling thread
+     * @param[in] table_size the number of positions to remember
+     */
+    explicit
+    PuzzleSolver(ThreadPool* pool = NULL, std::size_t table_size = 1 << 20);
+
+    /**
+     * Finds the series of at most @p max_moves moves that scores the most.
+     * @param[in] grid      the puzzle, with no matches on it
+     * @param[in] max_moves the most moves to make
+     *
+     * Of two series with the same score, the one whose moves come first in
+     * the order Grid::find_winning_swaps() gives them is chosen.
+     */
+    Solution
+    solve(Grid const& grid, int max_moves);
+
+    /** Gets the number of positions searched since the solver was made. */
+    std::uint64_t
+    positions_searched() const;
+
+    /**
+     * Gets the score of a move's cascade with each die rolling its average.
+     * @param[in] result what the move did
+     */
+    static double
+    expected_score(MoveResult const& result);
+
+  private:
+    /** Grids and lists to reuse at each depth of one search. */
+    struct Scratch
+    {
+      Scratch(Grid const& grid, int max_moves);
+
+      std::vector<Grid>                                 grids;
+      std::vector<Grid::MoveList>                       moves;
+      std::vector<std::vector<TranspositionTable::Key>> seen;
+      std::vector<int>                                  best_moves;
+      MoveResult                                        result;
+    };
+
+    double
+    search(Grid const& grid, int moves_left, Scratch& scratch);
+
+    double
+    play(Grid const& grid, Grid::Move const& move, Grid& next,
+         MoveResult& result);
+
+  private:
+    ThreadPool*                pool_;
+    TranspositionTable         table_;
+    std::atomic<std::uint64_t> positions_searched_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_SOLVER_H
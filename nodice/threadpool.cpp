@@ -0,0 +1,130 @@
+/**
+ * @file nodice/threadpool.cpp
+ * @brief Implemntation of the nodice/threadpool module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/threadpool.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+NoDice::ThreadPool::
+ThreadPool(unsigned thread_count)
+: busy_count_(0)
+, is_stopping_(false)
+{
+  if (thread_count == 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned i = 0; i < thread_count; ++i)
+  {
+    threads_.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+
+NoDice::ThreadPool::
+~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  task_ready_.notify_all();
+  for (auto& thread: threads_)
+  {
+    thread.join();
+  }
+}
+
+
+unsigned NoDice::ThreadPool::
+size() const
+{
+  return threads_.size();
+}
+
+
+void NoDice::ThreadPool::
+submit(Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  task_ready_.notify_one();
+}
+
+
+void NoDice::ThreadPool::
+wait()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  all_done_.wait(lock, [this] { return tasks_.empty() && busy_count_ == 0; });
+}
+
+
+void NoDice::ThreadPool::
+parallel_for(int count, std::function<void(int)> const& fn)
+{
+  int const blocks = std::min<int>(count, size());
+  int remaining = blocks;
+  std::mutex remaining_mutex;
+  std::condition_variable finished;
+  for (int b = 0; b < blocks; ++b)
+  {
+    int const first = int(std::int64_t(count) * b / blocks);
+    int const last  = int(std::int64_t(count) * (b + 1) / blocks);
+    submit([first, last, &fn, &remaining, &remaining_mutex, &finished]
+           {
+             for (int i = first; i < last; ++i)
+               fn(i);
+             std::lock_guard<std::mutex> lock(remaining_mutex);
+             if (--remaining == 0)
+               finished.notify_one();
+           });
+  }
+
+  std::unique_lock<std::mutex> lock(remaining_mutex);
+  finished.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+
+void NoDice::ThreadPool::
+work()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    task_ready_.wait(lock, [this] { return is_stopping_ || !tasks_.empty(); });
+    if (tasks_.empty())
+      return;
+
+    Task task = std::move(tasks_.front());
+    tasks_.pop_front();
+    ++busy_count_;
+    lock.unlock();
+    task();
+    lock.lock();
+    --busy_count_;
+    if (tasks_.empty() && busy_count_ == 0)
+      all_done_.notify_all();
+  }
+}
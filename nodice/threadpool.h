@@ -0,0 +1,101 @@
+/**
+ * @file nodice/threadpool.h
+ * @brief Public interface of the nodice/threadpool module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_THREADPOOL_H
+#define NODICE_THREADPOOL_H 1
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace NoDice
+{
+
+  /**
+   * A fixed set of worker threads that run tasks from a queue.
+   *
+   * The queue is only touched when a task is handed out, so tasks should be
+   * big enough to be worth the trip: a whole game, or a whole slice of a big
+   * board, not a single cell.
+   */
+  class ThreadPool
+  {
+  public:
+    typedef std::function<void()> Task;
+
+  public:
+    /**
+     * Starts the worker threads.
+     * @param[in] thread_count the number of threads, or 0 for one per core
+     */
+    explicit
+    ThreadPool(unsigned thread_count = 0);
+
+    /** Finishes the queued tasks and stops the worker threads. */
+    ~ThreadPool();
+
+    /** Gets the number of worker threads. */
+    unsigned
+    size() const;
+
+    /** Queues a task to be run on one of the worker threads. */
+    void
+    submit(Task task);
+
+    /** Waits until every task submitted so far has finished. */
+    void
+    wait();
+
+    /**
+     * Runs fn(i) for each i in [0, count) across the worker threads and waits
+     * for them all to finish.  Each thread gets one contiguous block of i.
+     *
+     * Only the blocks are waited for, not any other tasks in the queue.  This
+     * must not be called from one of the pool's own worker threads.
+     */
+    void
+    parallel_for(int count, std::function<void(int)> const& fn);
+
+  private:
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    void
+    work();
+
+  private:
+    std::vector<std::thread> threads_;
+    std::deque<Task>         tasks_;
+    std::mutex               mutex_;
+    std::condition_variable  task_ready_;
+    std::condition_variable  all_done_;
+    unsigned                 busy_count_;
+    bool                     is_stopping_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_THREADPOOL_H
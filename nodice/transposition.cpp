@@ -0,0 +1,90 @@
+/**
+ * @file nodice/transposition.cpp
+ * @brief Implemntation of the nodice/transposition module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "nodice/transposition.h"
+
+
+namespace
+{
+  std::size_t
+  round_up_to_power_of_2(std::size_t n)
+  {
+    std::size_t power = 1;
+    while (power < n)
+      power <<= 1;
+    return power;
+  }
+} // anonymous namespace
+
+
+NoDice::TranspositionTable::
+TranspositionTable(std::size_t min_capacity)
+: mask_(round_up_to_power_of_2(min_capacity) - 1)
+, slots_(new Slot[mask_ + 1])
+{
+  clear();
+}
+
+
+std::size_t NoDice::TranspositionTable::
+capacity() const
+{
+  return mask_ + 1;
+}
+
+
+/**
+ * The low bits of a Zobrist hash are as good as any, so they pick the slot.
+ * Only the two stores need to be atomic, not the pair: a reader that sees one
+ * new word and one old one gets a check that does not match.
+ */
+void NoDice::TranspositionTable::
+store(Key key, Value value)
+{
+  Slot& slot = slots_[key & mask_];
+  slot.value.store(value, std::memory_order_relaxed);
+  slot.check.store(key ^ value, std::memory_order_relaxed);
+}
+
+
+bool NoDice::TranspositionTable::
+find(Key key, Value& value) const
+{
+  Slot const& slot = slots_[key & mask_];
+  Value const v = slot.value.load(std::memory_order_relaxed);
+  Key const check = slot.check.load(std::memory_order_relaxed);
+  if ((check ^ v) != key)
+    return false;
+  value = v;
+  return true;
+}
+
+
+void NoDice::TranspositionTable::
+clear()
+{
+  for (std::size_t i = 0; i <= mask_; ++i)
+  {
+    slots_[i].check.store(0, std::memory_order_relaxed);
+    slots_[i].value.store(0, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file nodice/transposition.h
+ * @brief Public interface of the nodice/transposition module.
+ */
+/*
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This file is part of no-dice.
+ *
+ * No-dice is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * No-dice is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with no-dice.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NODICE_TRANSPOSITION_H
+#define NODICE_TRANSPOSITION_H 1
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+namespace NoDice
+{
+
+  /**
+   * A fixed-size cache of evaluations keyed by position hash, for skipping
+   * positions a search has already seen.
+   *
+   * Any number of threads can store and find at once without locking.  Each
+   * slot keeps its value alongside the key XORed with the value, so a slot
+   * half-written by another thread fails the check and reads as a miss rather
+   * than as someone else's value.  A new entry always replaces whatever was in
+   * its slot.
+   *
+   * The value is 64 bits for the caller to pack as it likes.  An empty slot
+   * holds key 0 with value 0, so key 0 is best avoided.
+   */
+  class TranspositionTable
+  {
+  public:
+    typedef std::uint64_t Key;
+    typedef std::uint64_t Value;
+
+  public:
+    /**
+     * Constructs an empty table.
+     * @param[in] min_capacity the least number of entries to hold, which is
+     *                         rounded up to a power of 2
+     */
+    explicit
+    TranspositionTable(std::size_t min_capacity);
+
+    /** Gets the number of entries the table can hold. */
+    std::size_t
+    capacity() const;
+
+    /** Stores a value for a key, replacing whatever shared its slot. */
+    void
+    store(Key key, Value value);
+
+    /**
+     * Looks up the value for a key.
+     * @param[out] value receives the value, if it is found
+     * @returns true if the key was found
+     */
+    bool
+    find(Key key, Value& value) const;
+
+    /** Empties every slot.  No other thread may be using the table. */
+    void
+    clear();
+
+  private:
+    struct Slot
+    {
+      std::atomic<Key>   check;  ///< the key XORed with the value
+      std::atomic<Value> value;
+    };
+
+    TranspositionTable(TranspositionTable const&) = delete;
+    TranspositionTable& operator=(TranspositionTable const&) = delete;
+
+  private:
+    std::size_t             mask_;
+    std::unique_ptr<Slot[]> slots_;
+  };
+
+} // namespace NoDice
+
+#endif // NODICE_TRANSPOSITION_H
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include "nodice/config.h"
+#include "nodice/glstate.h"
 #ifdef HAVE_EGL
 # include "nodice/videocontextegl.h"
 #else
@@ -36,14 +37,15 @@ namespace
   {
     initGlVboExtension();
 
-    glShadeModel(GL_SMOOTH);
+    NoDice::glState().forget();
+    NoDice::glState().shade_model(GL_SMOOTH);
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 #ifdef HAVE_OPENGL_ES
     glClearDepthf(1.0f);
 #else
     glClearDepth(1.0f);
 #endif
-    glEnable(GL_DEPTH_TEST);
+    NoDice::glState().enable(GL_DEPTH_TEST);
     glDepthFunc(GL_EQUAL);
     glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
   }
@@ -0,0 +1,114 @@
+/**
+ * @file test_animation.cpp
+ * @brief Unit tests for the nodice/animation module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/animation.h"
+
+
+SCENARIO("animating dice")
+{
+  GIVEN("a die at rest")
+  {
+    NoDice::Animation animation(4);
+    animation.start(2, NoDice::Vector3f(4.0f, 6.0f, 0.0f), 359, 90);
+
+    THEN("it is fully visible and stays put")
+    {
+      REQUIRE(animation.fade(2) == 1.0f);
+      REQUIRE(animation.is_falling(2) == false);
+      animation.update();
+      REQUIRE(animation.position(2).y == 6.0f);
+    }
+
+    WHEN("it is moved on a tick")
+    {
+      animation.update();
+
+      THEN("it spins, wrapping round at 360 degrees")
+      {
+        REQUIRE(animation.x_angle(2) == 0);
+        REQUIRE(animation.y_angle(2) == 96);
+      }
+    }
+
+    WHEN("it starts falling")
+    {
+      animation.start_falling(2, NoDice::Vector3f(4.0f, 2.0f, 0.0f));
+      int ticks = 0;
+      while (animation.is_falling(2) && ticks < 100)
+      {
+        animation.update();
+        ++ticks;
+      }
+
+      THEN("it arrives after a fixed number of ticks and stops")
+      {
+        REQUIRE(ticks == 10);
+        REQUIRE(animation.position(2).y == Approx(2.0f));
+        animation.update();
+        REQUIRE(animation.position(2).y == Approx(2.0f));
+      }
+    }
+
+    WHEN("it starts disappearing")
+    {
+      animation.start_disappearing(2);
+      int const x_angle = animation.x_angle(2);
+      int ticks = 0;
+      while (!animation.has_disappeared(2) && ticks < 100)
+      {
+        animation.update();
+        ++ticks;
+        REQUIRE(animation.x_angle(2) == x_angle);
+      }
+
+      THEN("it fades away after a fixed number of ticks without spinning")
+      {
+        REQUIRE(ticks == 20);
+        REQUIRE(animation.fade(2) == 0.0f);
+      }
+    }
+
+    WHEN("it is set drifting")
+    {
+      animation.set_velocity(2, NoDice::Vector3f(0.5f, 0.0f, 0.0f));
+      for (int i = 0; i < 30; ++i)
+        animation.update();
+
+      THEN("it keeps going until it is stopped")
+      {
+        REQUIRE(animation.position(2).x == Approx(19.0f));
+        animation.stop(2);
+        animation.update();
+        REQUIRE(animation.position(2).x == Approx(19.0f));
+      }
+    }
+
+    WHEN("the board it is on is turned a quarter turn clockwise")
+    {
+      animation.turn_clockwise(8.0f);
+
+      THEN("it moves to the matching place on the turned board")
+      {
+        REQUIRE(animation.position(2).x == 6.0f);
+        REQUIRE(animation.position(2).y == 4.0f);
+      }
+    }
+  }
+}
@@ -0,0 +1,207 @@
+/**
+ * @file test_bitboard.cpp
+ * @brief Unit tests for the nodice/bitboard module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/bitboard.h"
+
+#include <cstdlib>
+
+
+namespace
+{
+  /** The cell-by-cell scan the bitboard replaces. */
+  NoDice::BitBoard::RunList
+  scan_runs(NoDice::BitBoard const& board)
+  {
+    NoDice::BitBoard::RunList runs;
+    int const size = board.size();
+    for (int y = 0; y < size; ++y)
+    {
+      int x = 0;
+      while (x < size - 2)
+      {
+        int count = 1;
+        while (x + count < size && board.plane_at(x + count, y) == board.plane_at(x, y))
+          ++count;
+        if (count > 2)
+        {
+          runs.push_back(NoDice::BitBoard::Run{ x, y, 1, 0, count });
+          x += count;
+        }
+        else
+          ++x;
+      }
+    }
+    for (int x = 0; x < size; ++x)
+    {
+      int y = 0;
+      while (y < size - 2)
+      {
+        int count = 1;
+        while (y + count < size && board.plane_at(x, y + count) == board.plane_at(x, y))
+          ++count;
+        if (count > 2)
+        {
+          runs.push_back(NoDice::BitBoard::Run{ x, y, 0, 1, count });
+          y += count;
+        }
+        else
+          ++y;
+      }
+    }
+    return runs;
+  }
+} // anonymous namespace
+
+
+namespace NoDice
+{
+  bool
+  operator==(BitBoard::Run const& lhs, BitBoard::Run const& rhs)
+  {
+    return lhs.x == rhs.x && lhs.y == rhs.y
+        && lhs.dx == rhs.dx && lhs.dy == rhs.dy
+        && lhs.length == rhs.length;
+  }
+} // namespace NoDice
+
+
+SCENARIO("finding runs on a bitboard")
+{
+  GIVEN("an empty board")
+  {
+    NoDice::BitBoard board(8, 5);
+
+    THEN("every cell is empty and there are no runs")
+    {
+      NoDice::BitBoard::RunList runs;
+      board.find_runs(runs);
+      REQUIRE(board.plane_at(3, 4) == -1);
+      REQUIRE(runs.empty());
+    }
+
+    WHEN("a row of 4 and a crossing column of 3 are set")
+    {
+      for (int x = 2; x < 6; ++x)
+        board.set(x, 1, 3);
+      board.set(4, 2, 3);
+      board.set(4, 3, 3);
+
+      THEN("the row is found first and then the column")
+      {
+        NoDice::BitBoard::RunList runs;
+        board.find_runs(runs);
+        REQUIRE(runs.size() == 2);
+        REQUIRE(runs[0] == (NoDice::BitBoard::Run{ 2, 1, 1, 0, 4 }));
+        REQUIRE(runs[1] == (NoDice::BitBoard::Run{ 4, 1, 0, 1, 3 }));
+      }
+
+      AND_WHEN("two of the cells are swapped out of line")
+      {
+        board.set(2, 2, 0);
+        board.swap(2, 1, 2, 2);
+
+        THEN("the row is shortened")
+        {
+          NoDice::BitBoard::RunList runs;
+          board.find_runs(runs);
+          REQUIRE(board.plane_at(2, 1) == 0);
+          REQUIRE(board.plane_at(2, 2) == 3);
+          REQUIRE(runs.size() == 2);
+          REQUIRE(runs[0] == (NoDice::BitBoard::Run{ 3, 1, 1, 0, 3 }));
+        }
+      }
+    }
+  }
+
+  GIVEN("randomly filled boards that straddle word boundaries")
+  {
+    std::srand(17);
+
+    THEN("the runs are the same as a cell-by-cell scan")
+    {
+      for (int size: { 3, 8, 63, 64, 65, 130 })
+      {
+        INFO("board size " << size);
+        NoDice::BitBoard board(size, 3);
+        for (int y = 0; y < size; ++y)
+          for (int x = 0; x < size; ++x)
+            board.set(x, y, std::rand() % 3);
+
+        NoDice::BitBoard::RunList runs;
+        board.find_runs(runs);
+        NoDice::BitBoard::RunList expected = scan_runs(board);
+        REQUIRE(runs.size() == expected.size());
+        for (std::size_t i = 0; i < runs.size(); ++i)
+          REQUIRE(runs[i] == expected[i]);
+      }
+    }
+  }
+
+  GIVEN("a board that is played through swaps and cascades")
+  {
+    std::srand(42);
+    int const size = 70;
+    NoDice::BitBoard board(size, 5);
+    for (int y = 0; y < size; ++y)
+      for (int x = 0; x < size; ++x)
+        board.set(x, y, std::rand() % 5);
+
+    THEN("the dirty runs are always the same as a full scan")
+    {
+      NoDice::BitBoard::RunList runs;
+      for (int step = 0; step < 200; ++step)
+      {
+        INFO("step " << step);
+        board.find_dirty_runs(runs);
+        NoDice::BitBoard::RunList expected = scan_runs(board);
+        REQUIRE(runs.size() == expected.size());
+        for (std::size_t i = 0; i < runs.size(); ++i)
+          REQUIRE(runs[i] == expected[i]);
+
+        if (runs.empty())
+        {
+          int const x = std::rand() % (size - 1);
+          int const y = std::rand() % size;
+          board.swap(x, y, x + 1, y);
+          continue;
+        }
+
+        // clear the runs, drop what is above them, and refill from the top
+        for (auto const& run: runs)
+          for (int i = 0; i < run.length; ++i)
+            board.clear(run.x + i * run.dx, run.y + i * run.dy);
+        for (int x = 0; x < size; ++x)
+        {
+          int drop = 0;
+          for (int y = 0; y < size; ++y)
+          {
+            int const plane = board.plane_at(x, y);
+            if (plane < 0)
+              ++drop;
+            else if (drop > 0)
+              board.swap(x, y, x, y - drop);
+          }
+          for (int y = size - drop; y < size; ++y)
+            board.set(x, y, std::rand() % 5);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_capi.cpp
+ * @brief Unit tests for the no-dice rules library.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/capi.h"
+
+#include <algorithm>
+#include <vector>
+
+
+SCENARIO("driving games through the rules library")
+{
+  GIVEN("a board made with nonsense arguments")
+  {
+    THEN("there is no board")
+    {
+      REQUIRE(nodice_board_create(2, 5, 1) == NULL);
+      REQUIRE(nodice_board_create(8, 3, 1) == NULL);
+      REQUIRE(nodice_batch_create(0, 8, 5, 1) == NULL);
+    }
+  }
+
+  GIVEN("a board asked for with more shapes than there are dice")
+  {
+    THEN("there is no board, since the extra shapes could not be scored")
+    {
+      REQUIRE(nodice_board_create(8, 6, 3) == NULL);
+      REQUIRE(nodice_board_create(8, 100, 3) == NULL);
+      REQUIRE(nodice_batch_create(2, 8, 6, 3) == NULL);
+    }
+  }
+
+  GIVEN("a freshly made board")
+  {
+    nodice_board* board = nodice_board_create(5, 5, 1);
+    REQUIRE(board != NULL);
+    REQUIRE(nodice_board_size(board) == 5);
+
+    WHEN("the winning moves are asked for")
+    {
+      int const count = nodice_board_winning_moves(board, NULL, 0);
+      std::vector<int32_t> moves(count);
+      nodice_board_winning_moves(board, moves.data(), count);
+
+      THEN("there is at least one and making it scores")
+      {
+        REQUIRE(count > 0);
+        REQUIRE(nodice_board_move(board, moves[0]) > 0);
+      }
+    }
+
+    WHEN("a known layout is written to it")
+    {
+      // bottom row first
+      int8_t const cells[] = {
+        4, 0, 1, 2, 3,
+        3, 0, 0, 1, 2,
+        0, 3, 4, 0, 1,
+        1, 2, 3, 4, 0,
+        0, 1, 2, 3, 4,
+      };
+      REQUIRE(nodice_board_write(board, cells) == 0);
+      int8_t read[25];
+      nodice_board_read(board, read);
+
+      THEN("it reads back the same and the move is among the winning ones")
+      {
+        for (int i = 0; i < 25; ++i)
+          REQUIRE(read[i] == cells[i]);
+        int32_t moves[8];
+        int const count = nodice_board_winning_moves(board, moves, 8);
+        REQUIRE(count <= 8);
+        REQUIRE(std::count(moves, moves + count, 5 * 2 + 1) == 1);
+      }
+
+      AND_WHEN("a move that makes no match is made")
+      {
+        uint64_t const hash = nodice_board_hash(board);
+
+        THEN("it scores nothing and the board is left as it was")
+        {
+          REQUIRE(nodice_board_move(board, 0) == 0);
+          REQUIRE(nodice_board_hash(board) == hash);
+        }
+      }
+
+      AND_WHEN("moves off the board are made")
+      {
+        THEN("they are refused")
+        {
+          REQUIRE(nodice_board_move(board, 4 * 2) == NODICE_ERROR_ARGUMENT);
+          REQUIRE(nodice_board_swap(board, 20 * 2 + 1) == NODICE_ERROR_ARGUMENT);
+          REQUIRE(nodice_board_move(board, 50) == NODICE_ERROR_ARGUMENT);
+        }
+      }
+
+      AND_WHEN("the cells are swapped by hand and resolved")
+      {
+        REQUIRE(nodice_board_swap(board, 5 * 2 + 1) == 0);
+
+        THEN("the match scores")
+        {
+          REQUIRE(nodice_board_resolve(board) >= 3);
+        }
+      }
+    }
+
+    WHEN("a shape out of range is written to it")
+    {
+      int8_t cells[25] = { 0 };
+      cells[7] = 5;
+
+      THEN("it is refused")
+      {
+        REQUIRE(nodice_board_write(board, cells) == NODICE_ERROR_ARGUMENT);
+      }
+    }
+
+    nodice_board_destroy(board);
+  }
+
+  GIVEN("two boards with the same seed")
+  {
+    nodice_board* a = nodice_board_create(8, 5, 42);
+    nodice_board* b = nodice_board_create(8, 5, 42);
+
+    WHEN("one plays a series of moves in one call and the other one at a time")
+    {
+      std::vector<int32_t> moves;
+      for (int i = 0; i < 30; ++i)
+        moves.push_back((i * 37) % 112);
+      std::vector<int32_t> scores(moves.size());
+      int const total = nodice_board_play(a, moves.data(), int(moves.size()), scores.data());
+
+      int expected = 0;
+      bool is_same = true;
+      for (std::size_t i = 0; i < moves.size(); ++i)
+      {
+        int const score = nodice_board_move(b, moves[i]);
+        is_same = is_same && score == scores[i];
+        expected += score > 0 ? score : 0;
+      }
+
+      THEN("they end up the same")
+      {
+        REQUIRE(is_same);
+        REQUIRE(total == expected);
+        REQUIRE(nodice_board_hash(a) == nodice_board_hash(b));
+      }
+    }
+
+    nodice_board_destroy(a);
+    nodice_board_destroy(b);
+  }
+
+  GIVEN("a batch of boards")
+  {
+    nodice_batch* batch = nodice_batch_create(16, 8, 5, 7);
+    REQUIRE(nodice_batch_board_count(batch) == 16);
+
+    WHEN("every board makes a move")
+    {
+      std::vector<int8_t> cells(16 * 64);
+      nodice_batch_read(batch, cells.data());
+      std::vector<int32_t> moves(16, NODICE_NO_MOVE);
+      for (int b = 0; b < 16; ++b)
+      {
+        nodice_board* board = nodice_board_create(8, 5, 7 + b);
+        int32_t move;
+        nodice_board_winning_moves(board, &move, 1);
+        moves[b] = move;
+        nodice_board_destroy(board);
+      }
+      std::vector<int32_t> rewards(16);
+      std::vector<uint8_t> is_done(16);
+      nodice_batch_step(batch, moves.data(), rewards.data(), is_done.data());
+
+      THEN("every board is rewarded")
+      {
+        for (int b = 0; b < 16; ++b)
+          REQUIRE(rewards[b] >= 3);
+      }
+    }
+
+    nodice_batch_destroy(batch);
+  }
+}
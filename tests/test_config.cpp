@@ -32,6 +32,7 @@ SCENARIO("basic command line options handling")
     {
       REQUIRE(config.is_debug_mode() == false);
       REQUIRE(config.is_fullscreen() == false);
+      REQUIRE(config.is_console_mode() == false);
       REQUIRE(config.board_size() == 8);
     }
   }
@@ -57,6 +58,40 @@ SCENARIO("basic command line options handling")
       REQUIRE(config.is_fullscreen() == true);
     }
   }
+
+  WHEN("the -c switch is passed")
+  {
+    char* argv[] = { (char*)"no-dice", (char*)"-c" };
+    int argc = sizeof(argv) / sizeof(char*);
+    NoDice::Config config(argc, argv);
+    THEN("console mode is configured")
+    {
+      REQUIRE(config.is_console_mode() == true);
+    }
+  }
+
+  WHEN("the --seed option is passed")
+  {
+    char* argv[] = { (char*)"no-dice", (char*)"--seed", (char*)"12345" };
+    int argc = sizeof(argv) / sizeof(char*);
+    NoDice::Config config(argc, argv);
+    THEN("the random seed is configured")
+    {
+      REQUIRE(config.seed() == 12345);
+    }
+  }
+
+  WHEN("the --seed= option is passed")
+  {
+    char* argv[] = { (char*)"no-dice", (char*)"--seed=42", (char*)"-c" };
+    int argc = sizeof(argv) / sizeof(char*);
+    NoDice::Config config(argc, argv);
+    THEN("the random seed is configured and the next option is still seen")
+    {
+      REQUIRE(config.seed() == 42);
+      REQUIRE(config.is_console_mode() == true);
+    }
+  }
 }
 
 
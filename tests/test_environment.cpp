@@ -0,0 +1,145 @@
+/**
+ * @file test_environment.cpp
+ * @brief Unit tests for the nodice/environment module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/environment.h"
+
+#include "nodice/grid.h"
+#include <vector>
+
+
+namespace
+{
+  /**
+   * Plays a move out on a grid by hand, the way an Environment does, and
+   * works out the reward it should get.
+   */
+  int
+  play(NoDice::Grid& grid, NoDice::Vector2i const& p1, NoDice::Vector2i const& p2)
+  {
+    int reward = 0;
+    NoDice::Grid::RunList runs;
+    NoDice::Grid::FallList falls;
+    NoDice::Grid::CellList empties;
+    grid.swap(p1, p2);
+    grid.find_matches(runs);
+    if (runs.empty())
+      grid.swap(p1, p2);
+    for (int weight = 1; !runs.empty(); ++weight)
+    {
+      grid.remove(runs);
+      grid.collapse(falls, empties);
+      reward += weight * int(empties.size());
+      grid.refill(empties);
+      grid.find_matches(runs);
+    }
+    return reward;
+  }
+
+  bool
+  same_cells(NoDice::Environment const& env, int board, NoDice::Grid const& grid)
+  {
+    for (int y = 0; y < grid.size(); ++y)
+      for (int x = 0; x < grid.size(); ++x)
+        if (env.at(board, x, y) != grid.at(x, y))
+          return false;
+    return true;
+  }
+} // anonymous namespace
+
+
+SCENARIO("stepping many boards at once")
+{
+  GIVEN("an environment of 37 boards")
+  {
+    int const board_count = 37;
+    NoDice::Environment env(board_count, 8, 5, 100);
+    std::vector<NoDice::Grid> grids;
+    for (int b = 0; b < board_count; ++b)
+    {
+      grids.emplace_back(8, 5, 100 + b);
+      grids.back().generate();
+    }
+
+    THEN("each board starts out the same as a grid with the same seed")
+    {
+      for (int b = 0; b < board_count; ++b)
+        REQUIRE(same_cells(env, b, grids[b]));
+    }
+
+    WHEN("a series of moves is made on every board")
+    {
+      std::vector<NoDice::Environment::Action> actions(board_count);
+      std::vector<std::int32_t> rewards(board_count);
+      std::vector<std::uint8_t> is_done(board_count);
+      std::vector<int> expected(board_count);
+      bool is_same = true;
+      for (int turn = 0; turn < 20; ++turn)
+      {
+        for (int b = 0; b < board_count; ++b)
+        {
+          NoDice::Grid::MoveList swaps;
+          grids[b].find_winning_swaps(swaps);
+          NoDice::Vector2i p1(turn % 7, (turn * 3) % 8);
+          NoDice::Vector2i p2(p1.x + 1, p1.y);
+          if (!swaps.empty() && b % 3 != 0)
+          {
+            p1 = swaps[turn % swaps.size()].first;
+            p2 = swaps[turn % swaps.size()].second;
+          }
+          actions[b] = env.action(p1.x, p1.y, p2.x > p1.x ? NoDice::Environment::move_right
+                                                          : NoDice::Environment::move_up);
+          expected[b] = play(grids[b], p1, p2);
+        }
+        env.step(actions.data(), rewards.data(), is_done.data());
+        for (int b = 0; b < board_count; ++b)
+        {
+          is_same = is_same
+                 && rewards[b] == expected[b]
+                 && is_done[b] == !grids[b].has_winning_swap()
+                 && same_cells(env, b, grids[b]);
+          if (is_done[b])
+          {
+            env.reset(b);
+            grids[b].generate();
+          }
+        }
+      }
+
+      THEN("each board plays out the same as its grid")
+      {
+        REQUIRE(is_same);
+      }
+    }
+
+    WHEN("the boards are observed")
+    {
+      std::vector<NoDice::ShapeId> cells(board_count * 8 * 8);
+      env.observe(cells.data());
+
+      THEN("each board's cells come out together")
+      {
+        for (int b = 0; b < board_count; ++b)
+          for (int y = 0; y < 8; ++y)
+            for (int x = 0; x < 8; ++x)
+              REQUIRE(cells[b * 64 + x + y * 8] == grids[b].at(x, y));
+      }
+    }
+  }
+}
@@ -0,0 +1,622 @@
+/**
+ * @file test_grid.cpp
+ * @brief Unit tests for the nodice/grid module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/cascade.h"
+#include "nodice/grid.h"
+#include "nodice/pattern.h"
+#include "nodice/threadpool.h"
+
+#include <algorithm>
+
+
+namespace
+{
+  /**
+   * Lays out a grid from rows of digits, top row first, so a test reads the
+   * way the board looks.  A '.' is an empty cell.
+   */
+  void
+  layout(NoDice::Grid& grid, char const* const rows[])
+  {
+    for (int i = 0; i < grid.size(); ++i)
+    {
+      int const y = grid.size() - i - 1;
+      for (int x = 0; x < grid.size(); ++x)
+      {
+        char const c = rows[i][x];
+        grid.set(x, y, c == '.' ? NoDice::no_shape : NoDice::ShapeId(c - '0'));
+      }
+    }
+  }
+
+  /**
+   * Plays out the matches on a grid a step at a time and adds up the score
+   * the way PlayState::calculateScore does: for each group, the step it was
+   * found in, the bonus for its pattern, and a roll of each of its dice.
+   */
+  int
+  game_score(NoDice::Grid& grid)
+  {
+    NoDice::PatternMatcher matcher(grid.size());
+    NoDice::MatchGroupList groups;
+    NoDice::Grid::RunList runs;
+    NoDice::Grid::FallList falls;
+    NoDice::Grid::CellList empties;
+
+    int score = 0;
+    grid.find_matches(runs);
+    for (int multiplier = 0; !runs.empty(); ++multiplier)
+    {
+      matcher.group(grid, runs, groups);
+      for (auto const& group: groups)
+      {
+        score += multiplier + NoDice::pattern_bonus(group.pattern);
+        for (std::size_t i = 0; i < group.cells.size(); ++i)
+          score += NoDice::roll_die(group.shape, grid.random());
+      }
+      grid.remove(runs);
+      grid.collapse(falls, empties);
+      grid.refill(empties);
+      grid.find_matches(runs);
+    }
+    return score;
+  }
+} // anonymous namespace
+
+
+SCENARIO("playing out a move on a grid")
+{
+  GIVEN("a grid with one move that makes a match")
+  {
+    char const* const rows[] = {
+      "01234",
+      "12340",
+      "03401",
+      "30012",
+      "40123",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+
+    NoDice::Grid::RunList runs;
+    grid.find_matches(runs);
+    REQUIRE(runs.empty());
+
+    WHEN("the 3 is swapped in line with the 0s")
+    {
+      grid.swap(NoDice::Vector2i(0, 1), NoDice::Vector2i(0, 2));
+      grid.find_matches(runs);
+
+      THEN("the row of 0s is found")
+      {
+        REQUIRE(runs.size() == 1);
+        REQUIRE(runs[0].x == 0);
+        REQUIRE(runs[0].y == 1);
+        REQUIRE(runs[0].length == 3);
+      }
+
+      AND_WHEN("the match is removed and the grid collapses")
+      {
+        grid.remove(runs);
+        NoDice::Grid::FallList falls;
+        NoDice::Grid::CellList empties;
+        grid.collapse(falls, empties);
+
+        THEN("the shapes above fall down one and the top row is empty")
+        {
+          REQUIRE(falls.size() == 9);
+          REQUIRE(empties.size() == 3);
+          REQUIRE(grid.at(0, 1) == 3);
+          REQUIRE(grid.at(1, 1) == 3);
+          REQUIRE(grid.at(2, 3) == 2);
+          REQUIRE(grid.at(3, 1) == 1);
+          for (auto const& cell: empties)
+          {
+            REQUIRE(cell.y == 4);
+            REQUIRE(grid.at(cell.x, cell.y) == NoDice::no_shape);
+          }
+        }
+
+        AND_WHEN("the grid is refilled")
+        {
+          grid.refill(empties);
+
+          THEN("every cell holds a shape")
+          {
+            for (int y = 0; y < grid.size(); ++y)
+              for (int x = 0; x < grid.size(); ++x)
+              {
+                REQUIRE(grid.at(x, y) >= 0);
+                REQUIRE(grid.at(x, y) < grid.shape_count());
+              }
+          }
+        }
+      }
+    }
+  }
+
+  GIVEN("the same grid played out in one go")
+  {
+    char const* const rows[] = {
+      "01234",
+      "12340",
+      "03401",
+      "30012",
+      "40123",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+    NoDice::MoveResult result;
+    NoDice::resolve_cascade(grid, result);
+    REQUIRE(result.steps.empty());
+
+    WHEN("a move that makes no match is made")
+    {
+      bool is_legal = NoDice::resolve_move(grid,
+                                           NoDice::Vector2i(0, 0),
+                                           NoDice::Vector2i(1, 0),
+                                           result);
+
+      THEN("it is swapped back and scores nothing")
+      {
+        REQUIRE(is_legal == false);
+        REQUIRE(result.steps.empty());
+        REQUIRE(result.score == 0);
+        REQUIRE(grid.at(0, 0) == 4);
+        REQUIRE(grid.at(1, 0) == 0);
+      }
+    }
+
+    WHEN("the move that makes a match is made")
+    {
+      bool is_legal = NoDice::resolve_move(grid,
+                                           NoDice::Vector2i(0, 1),
+                                           NoDice::Vector2i(0, 2),
+                                           result);
+
+      THEN("the whole cascade is played out and scored")
+      {
+        REQUIRE(is_legal == true);
+        REQUIRE(result.steps.size() >= 1);
+        REQUIRE(result.steps[0].matches.size() == 1);
+        NoDice::Match const& match = result.steps[0].matches[0];
+        REQUIRE(match.shape == 0);
+        REQUIRE(match.score >= 3);
+        REQUIRE(match.score <= 3 * NoDice::die_faces(0));
+
+        int total = 0;
+        for (auto const& step: result.steps)
+          total += step.score;
+        REQUIRE(result.score == total);
+
+        NoDice::Grid::RunList runs;
+        grid.find_matches(runs);
+        REQUIRE(runs.empty());
+      }
+    }
+  }
+
+  GIVEN("boards with an L, a T and a cross on them")
+  {
+    char const* const l_rows[] = {
+      "1234123",
+      "3412341",
+      "1234123",
+      "3012341",
+      "1034123",
+      "3000341",
+      "1234123",
+    };
+    char const* const t_rows[] = {
+      "1234123",
+      "3412341",
+      "1234123",
+      "3000341",
+      "1204123",
+      "3402341",
+      "1234123",
+    };
+    char const* const plus_rows[] = {
+      "1234123",
+      "3412341",
+      "1234123",
+      "3410341",
+      "1200023",
+      "3410341",
+      "1234123",
+    };
+    struct { char const* const* rows; NoDice::Pattern pattern; } const boards[] = {
+      { l_rows,    NoDice::pattern_l },
+      { t_rows,    NoDice::pattern_t },
+      { plus_rows, NoDice::pattern_plus },
+    };
+
+    THEN("each is one match of 5 dice and scores what the game would")
+    {
+      for (auto const& board: boards)
+      {
+        NoDice::Grid grid(7, 5, 11);
+        layout(grid, board.rows);
+        NoDice::Grid played(grid);
+        NoDice::MoveResult result;
+        NoDice::resolve_cascade(grid, result);
+
+        REQUIRE(result.steps.size() >= 1);
+        REQUIRE(result.steps[0].matches.size() == 1);
+        NoDice::Match const& match = result.steps[0].matches[0];
+        REQUIRE(match.pattern == board.pattern);
+        REQUIRE(match.cells.size() == 5);
+        REQUIRE(match.score >= NoDice::pattern_bonus(board.pattern) + 5);
+        REQUIRE(result.score == game_score(played));
+      }
+    }
+  }
+
+  GIVEN("a randomly filled grid with no matches on it")
+  {
+    NoDice::Grid grid(9, 5, 7);
+    grid.fill();
+    NoDice::MoveResult result;
+    NoDice::resolve_cascade(grid, result);
+
+    THEN("the winning swaps are the ones that make a match when tried")
+    {
+      NoDice::Grid::MoveList expected;
+      for (int y = 0; y < grid.size(); ++y)
+        for (int x = 0; x < grid.size(); ++x)
+          for (auto const& to: { NoDice::Vector2i(x + 1, y), NoDice::Vector2i(x, y + 1) })
+          {
+            if (to.x >= grid.size() || to.y >= grid.size())
+              continue;
+            NoDice::Grid trial(grid);
+            NoDice::Grid::RunList runs;
+            trial.swap(NoDice::Vector2i(x, y), to);
+            trial.find_matches(runs);
+            if (!runs.empty())
+              expected.push_back(std::make_pair(NoDice::Vector2i(x, y), to));
+          }
+
+      NoDice::Grid::MoveList swaps;
+      grid.find_winning_swaps(swaps);
+      REQUIRE(swaps.size() == expected.size());
+      for (std::size_t i = 0; i < swaps.size(); ++i)
+      {
+        REQUIRE(swaps[i].first == expected[i].first);
+        REQUIRE(swaps[i].second == expected[i].second);
+      }
+    }
+  }
+
+
+  GIVEN("a grid on which no swap makes a match")
+  {
+    char const* const rows[] = {
+      "01234",
+      "23401",
+      "40123",
+      "12340",
+      "34012",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+
+    THEN("there are no winning swaps")
+    {
+      NoDice::Grid::MoveList swaps;
+      grid.find_winning_swaps(swaps);
+      REQUIRE(swaps.empty());
+      REQUIRE(grid.has_winning_swap() == false);
+    }
+
+    WHEN("it is rearranged")
+    {
+      int counts[5] = { 0 };
+      bool const is_rearranged = grid.rearrange();
+      for (int y = 0; y < grid.size(); ++y)
+        for (int x = 0; x < grid.size(); ++x)
+          ++counts[grid.at(x, y)];
+      NoDice::Grid::RunList runs;
+      grid.find_matches(runs);
+
+      THEN("it holds the same shapes with no match and a winning swap")
+      {
+        REQUIRE(is_rearranged);
+        for (int count: counts)
+          REQUIRE(count == 5);
+        REQUIRE(runs.empty());
+        REQUIRE(grid.has_winning_swap());
+      }
+    }
+  }
+
+  GIVEN("a grid with a single winning swap")
+  {
+    char const* const rows[] = {
+      "01234",
+      "12340",
+      "03401",
+      "30012",
+      "40123",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+
+    THEN("it is found whichever way round the cells are given")
+    {
+      REQUIRE(grid.has_winning_swap() == true);
+      REQUIRE(grid.is_winning_swap(NoDice::Vector2i(0, 1), NoDice::Vector2i(0, 2)));
+      REQUIRE(grid.is_winning_swap(NoDice::Vector2i(0, 2), NoDice::Vector2i(0, 1)));
+      REQUIRE_FALSE(grid.is_winning_swap(NoDice::Vector2i(0, 0), NoDice::Vector2i(1, 0)));
+    }
+  }
+
+  GIVEN("freshly generated grids of many sizes")
+  {
+    THEN("none has a match on it and every one has a winning swap")
+    {
+      for (int size: { 3, 4, 5, 8, 9, 16, 70 })
+        for (int seed = 0; seed < 20; ++seed)
+        {
+          NoDice::Grid grid(size, 5, seed);
+          grid.generate();
+          NoDice::Grid::RunList runs;
+          grid.find_matches(runs);
+          REQUIRE(runs.empty());
+          REQUIRE(grid.has_winning_swap());
+        }
+    }
+  }
+
+  GIVEN("generated grids of many sizes laid out again")
+  {
+    THEN("every one keeps its shapes, has no match and has a winning swap")
+    {
+      for (int size: { 4, 5, 8, 9, 16, 70 })
+        for (int seed = 0; seed < 20; ++seed)
+        {
+          NoDice::Grid grid(size, 5, seed);
+          grid.generate();
+          int before[5] = { 0 };
+          for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+              ++before[grid.at(x, y)];
+          REQUIRE(grid.rearrange());
+          int after[5] = { 0 };
+          for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+              ++after[grid.at(x, y)];
+          NoDice::Grid::RunList runs;
+          grid.find_matches(runs);
+          REQUIRE(std::equal(before, before + 5, after));
+          REQUIRE(runs.empty());
+          REQUIRE(grid.has_winning_swap());
+        }
+    }
+  }
+
+  GIVEN("a grid with no shape on it 3 times")
+  {
+    NoDice::Grid grid(4, 16, 1);
+    for (int y = 0; y < grid.size(); ++y)
+      for (int x = 0; x < grid.size(); ++x)
+        grid.set(x, y, NoDice::ShapeId(x + y * grid.size()));
+    NoDice::Grid const before(grid);
+
+    THEN("it cannot be rearranged and is left as it was")
+    {
+      REQUIRE_FALSE(grid.rearrange());
+      REQUIRE(grid.hash() == before.hash());
+    }
+  }
+
+  GIVEN("a grid with too many of one shape to lay out without a line")
+  {
+    NoDice::Grid grid(5, 5, 1);
+    for (int y = 0; y < grid.size(); ++y)
+      for (int x = 0; x < grid.size(); ++x)
+        grid.set(x, y, (x + y) % 5 == 4 ? 1 : 0);
+    NoDice::Grid const before(grid);
+
+    THEN("it cannot be rearranged and is left as it was")
+    {
+      REQUIRE_FALSE(grid.rearrange());
+      REQUIRE(grid.hash() == before.hash());
+    }
+  }
+
+  GIVEN("a generated grid with only 3 shapes")
+  {
+    NoDice::Grid grid(9, 3, 5);
+    grid.generate();
+
+    THEN("it still has no match on it")
+    {
+      NoDice::Grid::RunList runs;
+      grid.find_matches(runs);
+      REQUIRE(runs.empty());
+    }
+  }
+
+  GIVEN("a generated grid")
+  {
+    NoDice::Grid grid(9, 5, 13);
+    grid.generate();
+    NoDice::Grid::Hash const start = grid.hash();
+
+    WHEN("two cells are swapped and swapped back")
+    {
+      grid.swap(NoDice::Vector2i(3, 3), NoDice::Vector2i(3, 4));
+      NoDice::Grid::Hash const swapped = grid.hash();
+      grid.swap(NoDice::Vector2i(3, 3), NoDice::Vector2i(3, 4));
+
+      THEN("the hash changes and then comes back")
+      {
+        REQUIRE(swapped != start);
+        REQUIRE(grid.hash() == start);
+      }
+    }
+
+    WHEN("a move is played out")
+    {
+      NoDice::Grid::MoveList swaps;
+      grid.find_winning_swaps(swaps);
+      NoDice::MoveResult result;
+      NoDice::resolve_move(grid, swaps[0].first, swaps[0].second, result);
+
+      THEN("the hash is the same as a grid built up from scratch")
+      {
+        NoDice::Grid copy(9, 5, 1);
+        for (int y = 0; y < grid.size(); ++y)
+          for (int x = 0; x < grid.size(); ++x)
+            copy.set(x, y, grid.at(x, y));
+        REQUIRE(grid.hash() != start);
+        REQUIRE(copy.hash() == grid.hash());
+      }
+    }
+  }
+
+  GIVEN("two copies of a big grid with holes in it, one with a thread pool")
+  {
+    NoDice::ThreadPool pool(4);
+    NoDice::Grid serial(300, 5, 3);
+    serial.fill();
+    NoDice::Random holes(11);
+    for (int i = 0; i < 20000; ++i)
+      serial.set(holes.below(300), holes.below(300), NoDice::no_shape);
+    NoDice::Grid parallel(serial);
+    parallel.set_thread_pool(&pool);
+
+    WHEN("both are collapsed and refilled")
+    {
+      NoDice::Grid::FallList serial_falls, parallel_falls;
+      NoDice::Grid::CellList serial_empties, parallel_empties;
+      serial.collapse(serial_falls, serial_empties);
+      parallel.collapse(parallel_falls, parallel_empties);
+
+      THEN("the same shapes fall the same way")
+      {
+        REQUIRE(parallel_falls.size() == serial_falls.size());
+        for (std::size_t i = 0; i < serial_falls.size(); ++i)
+        {
+          REQUIRE(parallel_falls[i].x == serial_falls[i].x);
+          REQUIRE(parallel_falls[i].from_y == serial_falls[i].from_y);
+          REQUIRE(parallel_falls[i].to_y == serial_falls[i].to_y);
+        }
+        REQUIRE(parallel_empties == serial_empties);
+        REQUIRE(parallel.hash() == serial.hash());
+      }
+
+      AND_WHEN("they are refilled")
+      {
+        serial.refill(serial_empties);
+        parallel.refill(parallel_empties);
+
+        THEN("they end up holding the same shapes and the same matches")
+        {
+          for (int y = 0; y < serial.size(); ++y)
+            for (int x = 0; x < serial.size(); ++x)
+              REQUIRE(parallel.at(x, y) == serial.at(x, y));
+          REQUIRE(parallel.hash() == serial.hash());
+
+          NoDice::Grid::RunList serial_runs, parallel_runs;
+          serial.find_matches(serial_runs);
+          parallel.find_matches(parallel_runs);
+          REQUIRE(parallel_runs.size() == serial_runs.size());
+        }
+      }
+    }
+  }
+
+  GIVEN("a grid with a gap at the right of its bottom row")
+  {
+    char const* const rows[] = {
+      "01234",
+      "12340",
+      "03401",
+      "40012",
+      "4012.",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+
+    WHEN("it is rotated")
+    {
+      grid.rotate();
+
+      THEN("each shape moves a quarter turn clockwise")
+      {
+        for (int y = 0; y < grid.size(); ++y)
+          for (int x = 0; x < grid.size(); ++x)
+          {
+            char const c = rows[grid.size() - 1 - y][x];
+            NoDice::ShapeId const shape = (c == '.') ? NoDice::no_shape : c - '0';
+            REQUIRE(grid.at(y, grid.size() - 1 - x) == shape);
+          }
+      }
+
+      THEN("the hash is the same as a grid built up from scratch")
+      {
+        NoDice::Grid copy(5, 5, 1);
+        for (int y = 0; y < grid.size(); ++y)
+          for (int x = 0; x < grid.size(); ++x)
+            copy.set(x, y, grid.at(x, y));
+        REQUIRE(copy.hash() == grid.hash());
+      }
+
+      AND_WHEN("it collapses")
+      {
+        NoDice::Grid::FallList falls;
+        NoDice::Grid::CellList empties;
+        grid.collapse(falls, empties);
+
+        THEN("the shapes beside the gap fall along what was the bottom row")
+        {
+          REQUIRE(falls.size() == 4);
+          REQUIRE(empties.size() == 1);
+          REQUIRE(empties[0].x == 0);
+          REQUIRE(empties[0].y == 4);
+          REQUIRE(grid.at(0, 0) == 2);
+          REQUIRE(grid.at(0, 3) == 4);
+        }
+      }
+    }
+  }
+
+  GIVEN("a grid bigger than one tile of the turn")
+  {
+    NoDice::Grid grid(37, 5, 9);
+    grid.fill();
+    NoDice::Grid start(grid);
+
+    WHEN("it is rotated four times")
+    {
+      for (int i = 0; i < 4; ++i)
+        grid.rotate();
+
+      THEN("it is back where it started")
+      {
+        for (int y = 0; y < grid.size(); ++y)
+          for (int x = 0; x < grid.size(); ++x)
+            REQUIRE(grid.at(x, y) == start.at(x, y));
+        REQUIRE(grid.hash() == start.hash());
+      }
+    }
+  }
+}
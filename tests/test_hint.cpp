@@ -0,0 +1,150 @@
+/**
+ * @file test_hint.cpp
+ * @brief Unit tests for the nodice/hint module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/hint.h"
+
+#include <thread>
+
+
+namespace
+{
+  /** Waits a while for a request to finish. */
+  bool
+  wait_for_hint(NoDice::HintEngine& engine, NoDice::Hint& hint)
+  {
+    for (int i = 0; i < 1000 && engine.is_busy(); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return engine.poll(hint);
+  }
+
+  void
+  layout(NoDice::Grid& grid, char const* const rows[])
+  {
+    for (int i = 0; i < grid.size(); ++i)
+    {
+      int const y = grid.size() - i - 1;
+      for (int x = 0; x < grid.size(); ++x)
+        grid.set(x, y, NoDice::ShapeId(rows[i][x] - '0'));
+    }
+  }
+} // anonymous namespace
+
+
+SCENARIO("asking for a hint")
+{
+  NoDice::HintEngine engine(17, 50, 2);
+  NoDice::Hint hint;
+
+  GIVEN("a grid with a single winning swap")
+  {
+    char const* const rows[] = {
+      "01234",
+      "12340",
+      "03401",
+      "30012",
+      "40123",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+
+    WHEN("a hint is asked for")
+    {
+      engine.request(grid, NoDice::HintEngine::Budget(5000));
+
+      THEN("that swap is the hint")
+      {
+        REQUIRE(wait_for_hint(engine, hint));
+        REQUIRE(hint.move.first == NoDice::Vector2i(0, 1));
+        REQUIRE(hint.move.second == NoDice::Vector2i(0, 2));
+        REQUIRE(hint.rollout_count == 50);
+        REQUIRE(hint.mean_score >= 3.0);
+        REQUIRE_FALSE(engine.is_busy());
+      }
+    }
+
+    WHEN("a hint is asked for twice")
+    {
+      engine.request(grid, NoDice::HintEngine::Budget(5000));
+      REQUIRE(wait_for_hint(engine, hint));
+      NoDice::Hint const first = hint;
+      engine.request(grid, NoDice::HintEngine::Budget(5000));
+
+      THEN("the second time it comes from the table")
+      {
+        REQUIRE(wait_for_hint(engine, hint));
+        REQUIRE(hint.move == first.move);
+        REQUIRE(hint.mean_score == Approx(first.mean_score));
+      }
+    }
+
+    WHEN("a hint is asked for and then cancelled")
+    {
+      engine.request(grid, NoDice::HintEngine::Budget(5000));
+      engine.cancel();
+
+      THEN("there is no hint")
+      {
+        REQUIRE_FALSE(engine.is_busy());
+        REQUIRE_FALSE(engine.poll(hint));
+      }
+    }
+  }
+
+  GIVEN("a grid on which no swap makes a match")
+  {
+    char const* const rows[] = {
+      "01234",
+      "23401",
+      "40123",
+      "12340",
+      "34012",
+    };
+    NoDice::Grid grid(5, 5, 1);
+    layout(grid, rows);
+
+    WHEN("a hint is asked for")
+    {
+      engine.request(grid, NoDice::HintEngine::Budget(5000));
+
+      THEN("there is no hint")
+      {
+        REQUIRE_FALSE(wait_for_hint(engine, hint));
+      }
+    }
+  }
+
+  GIVEN("a big generated grid and no time to spare")
+  {
+    NoDice::Grid grid(64, 5, 3);
+    grid.generate();
+
+    WHEN("a hint is asked for")
+    {
+      engine.request(grid, NoDice::HintEngine::Budget(0));
+
+      THEN("a winning swap still comes back after a rollout of each")
+      {
+        REQUIRE(wait_for_hint(engine, hint));
+        REQUIRE(hint.rollout_count == 1);
+        REQUIRE(grid.is_winning_swap(hint.move.first, hint.move.second));
+      }
+    }
+  }
+}
@@ -0,0 +1,244 @@
+/**
+ * @file test_history.cpp
+ * @brief Unit tests for the nodice/history module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/dice.h"
+#include "nodice/history.h"
+#include "nodice/pattern.h"
+
+
+namespace
+{
+  /**
+   * Plays a move out on a grid and records it, the way the board does.  On a
+   * grid with more shapes than there are dice, the shapes take the dice in
+   * turn.
+   * @returns the score of the move
+   */
+  int
+  play(NoDice::Grid& grid, NoDice::History& history, NoDice::Grid::Move const& move)
+  {
+    NoDice::PatternMatcher matcher(grid.size());
+    NoDice::MatchGroupList groups;
+    NoDice::Grid::RunList runs;
+    NoDice::Grid::FallList falls;
+    NoDice::Grid::CellList empties;
+    std::vector<int> rolls;
+
+    int score = 0;
+    grid.swap(move.first, move.second);
+    history.begin_move(grid, move);
+    grid.find_matches(runs);
+    for (int multiplier = 0; !runs.empty(); ++multiplier)
+    {
+      matcher.group(grid, runs, groups);
+      rolls.clear();
+      for (auto const& group: groups)
+      {
+        for (std::size_t i = 0; i < group.cells.size(); ++i)
+        {
+          rolls.push_back(NoDice::roll_die(group.shape % NoDice::die_count, grid.random()));
+          score += rolls.back();
+        }
+      }
+      int const bonus = multiplier * int(groups.size());
+      score += bonus;
+      history.add_removed(grid, groups);
+      history.add_score(rolls, bonus);
+
+      grid.remove(runs);
+      grid.collapse(falls, empties);
+      grid.refill(empties);
+      history.add_refills(grid, empties);
+      grid.find_matches(runs);
+    }
+
+    if (!grid.has_winning_swap())
+    {
+      history.begin_rearrange(grid);
+      if (grid.rearrange())
+        history.end_rearrange(grid);
+    }
+    history.end_move();
+    return score;
+  }
+
+  bool
+  same_cells(NoDice::Grid const& lhs, NoDice::Grid const& rhs)
+  {
+    for (int y = 0; y < lhs.size(); ++y)
+      for (int x = 0; x < lhs.size(); ++x)
+        if (lhs.at(x, y) != rhs.at(x, y))
+          return false;
+    return true;
+  }
+} // anonymous namespace
+
+
+SCENARIO("undoing and redoing turns")
+{
+  GIVEN("a grid with a move played on it")
+  {
+    NoDice::Grid grid(8, 5, 3);
+    grid.generate();
+    NoDice::Grid const start(grid);
+    NoDice::History history;
+    NoDice::Grid::MoveList moves;
+    grid.find_winning_swaps(moves);
+    int const score = play(grid, history, moves[0]);
+    NoDice::Grid const played(grid);
+    NoDice::Grid::CellList changed;
+
+    REQUIRE(history.undo_count() == 1);
+    REQUIRE(history.redo_count() == 0);
+
+    WHEN("the move is undone")
+    {
+      int const undone = history.undo(grid, changed);
+
+      THEN("the grid is back as it was and the score is taken back")
+      {
+        REQUIRE(undone == score);
+        REQUIRE(same_cells(grid, start));
+        REQUIRE(grid.hash() == start.hash());
+        REQUIRE(history.undo_count() == 0);
+        REQUIRE(history.redo_count() == 1);
+        REQUIRE(history.undo(grid, changed) == 0);
+        REQUIRE(changed.empty());
+      }
+
+      AND_WHEN("it is redone")
+      {
+        int const redone = history.redo(grid, changed);
+
+        THEN("the grid is the same as after the move was played")
+        {
+          REQUIRE(redone == score);
+          REQUIRE(same_cells(grid, played));
+          REQUIRE(grid.hash() == played.hash());
+          REQUIRE(history.redo_count() == 0);
+        }
+      }
+
+      AND_WHEN("another move is played instead")
+      {
+        grid.find_winning_swaps(moves);
+        play(grid, history, moves.back());
+
+        THEN("the undone move can no longer be redone")
+        {
+          REQUIRE(history.undo_count() == 1);
+          REQUIRE(history.redo_count() == 0);
+        }
+      }
+    }
+
+    WHEN("the grid is rotated as a turn of its own")
+    {
+      history.begin_rearrange(grid);
+      grid.rotate();
+      history.end_rearrange(grid);
+
+      THEN("the rotation is undone first and then the move")
+      {
+        REQUIRE(history.undo_count() == 2);
+        REQUIRE(history.undo(grid, changed) == 0);
+        REQUIRE(same_cells(grid, played));
+        REQUIRE(changed.size() > 0);
+        REQUIRE(history.undo(grid, changed) == score);
+        REQUIRE(same_cells(grid, start));
+      }
+    }
+  }
+
+  GIVEN("a long game on a big grid")
+  {
+    NoDice::Grid grid(64, 5, 17);
+    grid.generate();
+    NoDice::Grid::Hash const start = grid.hash();
+    NoDice::History history;
+    NoDice::Grid::MoveList moves;
+    int total = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+      grid.find_winning_swaps(moves);
+      total += play(grid, history, moves[grid.random().below(moves.size())]);
+    }
+    NoDice::Grid::Hash const end = grid.hash();
+
+    THEN("the whole history fits in a few megabytes")
+    {
+      REQUIRE(history.undo_count() == 10000);
+      REQUIRE(history.byte_count() < 4 * 1024 * 1024);
+    }
+
+    WHEN("every move is undone and then redone")
+    {
+      NoDice::Grid::CellList changed;
+      int undone = 0;
+      while (history.undo_count() > 0)
+        undone += history.undo(grid, changed);
+      NoDice::Grid::Hash const undone_hash = grid.hash();
+      int redone = 0;
+      while (history.redo_count() > 0)
+        redone += history.redo(grid, changed);
+
+      THEN("the grid goes back to the start and forward to the end")
+      {
+        REQUIRE(undone == total);
+        REQUIRE(undone_hash == start);
+        REQUIRE(redone == total);
+        REQUIRE(grid.hash() == end);
+      }
+    }
+  }
+
+  GIVEN("a game on a grid with too many shapes to keep in half a byte")
+  {
+    NoDice::Grid grid(16, 20, 5);
+    grid.generate();
+    NoDice::Grid const start(grid);
+    NoDice::History history;
+    NoDice::Grid::MoveList moves;
+    for (int i = 0; i < 20; ++i)
+    {
+      grid.find_winning_swaps(moves);
+      play(grid, history, moves[grid.random().below(moves.size())]);
+    }
+    NoDice::Grid const played(grid);
+
+    WHEN("every move is undone and then redone")
+    {
+      NoDice::Grid::CellList changed;
+      while (history.undo_count() > 0)
+        history.undo(grid, changed);
+      NoDice::Grid const undone(grid);
+      while (history.redo_count() > 0)
+        history.redo(grid, changed);
+
+      THEN("the shapes refilled from 15 up come back as they were")
+      {
+        REQUIRE(same_cells(undone, start));
+        REQUIRE(same_cells(grid, played));
+        REQUIRE(grid.hash() == played.hash());
+      }
+    }
+  }
+
+}
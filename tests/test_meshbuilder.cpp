@@ -0,0 +1,178 @@
+/**
+ * @file test_meshbuilder.cpp
+ * @brief Unit tests for the nodice/meshbuilder module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/meshbuilder.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+
+namespace
+{
+  typedef std::array<float, 3> Point;
+
+  /** Appends a row for a corner with a normal along z. */
+  void
+  corner(std::vector<float>& rows, float x, float y, float nz = 1.0f)
+  {
+    float const row[] = { x, y, 0.0f, 0.0f, 0.0f, nz };
+    rows.insert(rows.end(), row, row + NoDice::MeshBuilder::row_width);
+  }
+
+  /**
+   * Makes a flat square grid of cells, two triangles to a cell, written out
+   * as a soup one column of cells at a time.
+   */
+  std::vector<float>
+  grid_soup(int cells)
+  {
+    std::vector<float> rows;
+    for (int x = 0; x < cells; ++x)
+    {
+      for (int y = 0; y < cells; ++y)
+      {
+        corner(rows, x,     y);
+        corner(rows, x + 1, y);
+        corner(rows, x + 1, y + 1);
+        corner(rows, x,     y);
+        corner(rows, x + 1, y + 1);
+        corner(rows, x,     y + 1);
+      }
+    }
+    return rows;
+  }
+
+  /** Gets the triangles of a mesh as corner positions, in a fixed order. */
+  std::vector<std::array<Point, 3>>
+  triangles(NoDice::MeshBuilder const& mesh)
+  {
+    std::vector<std::array<Point, 3>> result;
+    std::vector<float> const& rows = mesh.rows();
+    std::vector<NoDice::MeshBuilder::Index> const& indexes = mesh.indexes();
+    for (std::size_t i = 0; i < indexes.size(); i += 3)
+    {
+      std::array<Point, 3> t;
+      for (int k = 0; k < 3; ++k)
+      {
+        float const* row = &rows[indexes[i + k] * NoDice::MeshBuilder::row_width];
+        t[k] = Point{{ row[0], row[1], row[2] }};
+      }
+      std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+      result.push_back(t);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+} // anonymous namespace
+
+
+SCENARIO("welding a triangle soup")
+{
+  GIVEN("a square made of two triangles sharing an edge")
+  {
+    std::vector<float> rows;
+    corner(rows, 0, 0);
+    corner(rows, 1, 0);
+    corner(rows, 1, 1);
+    corner(rows, 0, 0);
+    corner(rows, 1, 1);
+    corner(rows, 0, 1);
+
+    WHEN("the triangles are added to a mesh")
+    {
+      NoDice::MeshBuilder mesh;
+      mesh.add_triangles(rows.data(), 6);
+
+      THEN("the shared corners are only kept once")
+      {
+        REQUIRE(mesh.vertex_count() == 4);
+        REQUIRE(mesh.indexes() == (std::vector<NoDice::MeshBuilder::Index>{ 0, 1, 2, 0, 2, 3 }));
+      }
+    }
+  }
+
+  GIVEN("two triangles meeting at a corner with different normals")
+  {
+    std::vector<float> rows;
+    corner(rows, 0, 0);
+    corner(rows, 1, 0);
+    corner(rows, 1, 1);
+    corner(rows, 0, 0, -1.0f);
+    corner(rows, 1, 1, -1.0f);
+    corner(rows, 0, 1, -1.0f);
+
+    WHEN("the triangles are added to a mesh")
+    {
+      NoDice::MeshBuilder mesh;
+      mesh.add_triangles(rows.data(), 6);
+
+      THEN("the corners are not welded")
+      {
+        REQUIRE(mesh.vertex_count() == 6);
+      }
+    }
+  }
+}
+
+
+SCENARIO("ordering triangles for the vertex cache")
+{
+  GIVEN("a grid of triangles written out one column at a time")
+  {
+    int const cells = 24;
+    std::vector<float> rows = grid_soup(cells);
+    NoDice::MeshBuilder mesh;
+    mesh.add_triangles(rows.data(), int(rows.size()) / NoDice::MeshBuilder::row_width);
+    REQUIRE(mesh.vertex_count() == (cells + 1) * (cells + 1));
+
+    auto const before = triangles(mesh);
+    float const unordered = NoDice::MeshBuilder::average_cache_miss_ratio(mesh.indexes());
+
+    WHEN("the triangles are ordered")
+    {
+      mesh.optimize();
+
+      THEN("the mesh has the same triangles")
+      {
+        REQUIRE(mesh.vertex_count() == (cells + 1) * (cells + 1));
+        REQUIRE(triangles(mesh) == before);
+      }
+      AND_THEN("fewer vertexes miss the cache")
+      {
+        float const ordered = NoDice::MeshBuilder::average_cache_miss_ratio(mesh.indexes());
+        REQUIRE(ordered < unordered);
+        REQUIRE(ordered < 0.8f);
+      }
+      AND_THEN("the vertexes are numbered in the order they are first used")
+      {
+        int next = 0;
+        bool is_in_order = true;
+        for (NoDice::MeshBuilder::Index i: mesh.indexes())
+        {
+          is_in_order = is_in_order && int(i) <= next;
+          if (int(i) == next)
+            ++next;
+        }
+        REQUIRE(is_in_order);
+      }
+    }
+  }
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_pattern.cpp
+ * @brief Unit tests for the nodice/pattern module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/pattern.h"
+
+
+namespace
+{
+  /**
+   * Lays out a grid from rows of digits, top row first, with '.' for an
+   * empty cell.
+   */
+  void
+  layout(NoDice::Grid& grid, char const* const rows[])
+  {
+    for (int i = 0; i < grid.size(); ++i)
+    {
+      int const y = grid.size() - i - 1;
+      for (int x = 0; x < grid.size(); ++x)
+      {
+        char const c = rows[i][x];
+        grid.set(x, y, c == '.' ? NoDice::no_shape : NoDice::ShapeId(c - '0'));
+      }
+    }
+  }
+
+  /** Finds and groups the matches on a grid laid out from rows of digits. */
+  NoDice::MatchGroupList
+  match(char const* const rows[])
+  {
+    NoDice::Grid grid(6, 5, 1);
+    layout(grid, rows);
+    NoDice::Grid::RunList runs;
+    grid.find_matches(runs);
+    NoDice::PatternMatcher matcher(grid.size());
+    NoDice::MatchGroupList groups;
+    matcher.group(grid, runs, groups);
+    return groups;
+  }
+} // anonymous namespace
+
+
+SCENARIO("grouping matches into patterns")
+{
+  GIVEN("a single line of 3")
+  {
+    char const* const rows[] = {
+      "......",
+      "......",
+      "......",
+      ".000..",
+      "......",
+      "......",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("it is one plain line")
+    {
+      REQUIRE(groups.size() == 1);
+      REQUIRE(groups[0].shape == 0);
+      REQUIRE(groups[0].pattern == NoDice::pattern_line3);
+      REQUIRE(groups[0].cells.size() == 3);
+    }
+  }
+
+  GIVEN("lines of 4 and 5 of different shapes")
+  {
+    char const* const rows[] = {
+      "1.....",
+      "1.....",
+      "1.....",
+      "1.....",
+      "......",
+      "22222.",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("each is its own group with its own pattern")
+    {
+      REQUIRE(groups.size() == 2);
+      REQUIRE(groups[0].shape == 2);
+      REQUIRE(groups[0].pattern == NoDice::pattern_line5);
+      REQUIRE(groups[1].shape == 1);
+      REQUIRE(groups[1].pattern == NoDice::pattern_line4);
+    }
+  }
+
+  GIVEN("a cross")
+  {
+    char const* const rows[] = {
+      "......",
+      "..3...",
+      ".333..",
+      "..3...",
+      "......",
+      "......",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("the two runs make one group of 5 cells")
+    {
+      REQUIRE(groups.size() == 1);
+      REQUIRE(groups[0].pattern == NoDice::pattern_plus);
+      REQUIRE(groups[0].cells.size() == 5);
+    }
+  }
+
+  GIVEN("a T upside down")
+  {
+    char const* const rows[] = {
+      "......",
+      "..4...",
+      "..4...",
+      ".444..",
+      "......",
+      "......",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("it is found as a T")
+    {
+      REQUIRE(groups.size() == 1);
+      REQUIRE(groups[0].pattern == NoDice::pattern_t);
+      REQUIRE(groups[0].cells.size() == 5);
+    }
+  }
+
+  GIVEN("an L at the edge of the grid")
+  {
+    char const* const rows[] = {
+      ".....0",
+      ".....0",
+      "...000",
+      "......",
+      "......",
+      "......",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("it is found as an L")
+    {
+      REQUIRE(groups.size() == 1);
+      REQUIRE(groups[0].pattern == NoDice::pattern_l);
+    }
+  }
+
+  GIVEN("two lines of the same shape side by side")
+  {
+    char const* const rows[] = {
+      "......",
+      "......",
+      "111...",
+      "111...",
+      "......",
+      "......",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("they make one block with each cell in it once")
+    {
+      REQUIRE(groups.size() == 1);
+      REQUIRE(groups[0].pattern == NoDice::pattern_block);
+      REQUIRE(groups[0].cells.size() == 6);
+    }
+  }
+
+  GIVEN("lines of different shapes side by side")
+  {
+    char const* const rows[] = {
+      "......",
+      "......",
+      "111...",
+      "222...",
+      "......",
+      "......",
+    };
+    NoDice::MatchGroupList groups = match(rows);
+
+    THEN("they stay apart")
+    {
+      REQUIRE(groups.size() == 2);
+      REQUIRE(groups[0].pattern == NoDice::pattern_line3);
+      REQUIRE(groups[1].pattern == NoDice::pattern_line3);
+    }
+  }
+}
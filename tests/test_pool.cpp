@@ -0,0 +1,91 @@
+/**
+ * @file test_pool.cpp
+ * @brief Unit tests for the nodice/pool module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/pool.h"
+
+
+namespace
+{
+  /** Counts how many of itself are alive. */
+  struct Counted
+  {
+    Counted(int v) : value(v) { ++live; }
+    ~Counted() { --live; }
+
+    int        value;
+    static int live;
+  };
+
+  int Counted::live = 0;
+} // anonymous namespace
+
+
+SCENARIO("making and destroying objects in a pool")
+{
+  GIVEN("a pool with room for 3 objects")
+  {
+    {
+      NoDice::Pool<Counted> pool(3);
+      REQUIRE(pool.capacity() == 3);
+      REQUIRE(pool.size() == 0);
+
+      WHEN("it is filled")
+      {
+        auto h1 = pool.create(1);
+        auto h2 = pool.create(2);
+        auto h3 = pool.create(3);
+
+        THEN("each object can be found from its handle")
+        {
+          REQUIRE(pool.size() == 3);
+          REQUIRE(Counted::live == 3);
+          REQUIRE(pool[h1].value == 1);
+          REQUIRE(pool[h2].value == 2);
+          REQUIRE(pool[h3].value == 3);
+        }
+
+        THEN("no more will fit")
+        {
+          REQUIRE_THROWS(pool.create(4));
+        }
+
+        AND_WHEN("one is destroyed and another made")
+        {
+          pool.destroy(h2);
+          REQUIRE(Counted::live == 2);
+          auto h4 = pool.create(4);
+
+          THEN("the freed slot is reused")
+          {
+            REQUIRE(h4 == h2);
+            REQUIRE(pool[h4].value == 4);
+            REQUIRE(pool[h1].value == 1);
+            REQUIRE(pool.size() == 3);
+          }
+        }
+      }
+    }
+
+    THEN("destroying the pool destroys what is left in it")
+    {
+      REQUIRE(Counted::live == 0);
+    }
+  }
+}
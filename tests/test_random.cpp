@@ -0,0 +1,69 @@
+/**
+ * @file test_random.cpp
+ * @brief Unit tests for the nodice/random module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/random.h"
+
+
+SCENARIO("seeding the random number generator")
+{
+  GIVEN("two generators with the same seed")
+  {
+    NoDice::Random r1(12345);
+    NoDice::Random r2(12345);
+
+    THEN("they give the same numbers")
+    {
+      for (int i = 0; i < 100; ++i)
+        REQUIRE(r1() == r2());
+    }
+
+    WHEN("one is reseeded with a neighbouring seed")
+    {
+      r2.seed(12346);
+
+      THEN("they no longer give the same numbers")
+      {
+        int same = 0;
+        for (int i = 0; i < 100; ++i)
+          same += (r1() == r2());
+        REQUIRE(same == 0);
+      }
+    }
+  }
+
+  GIVEN("a generator")
+  {
+    NoDice::Random random(7);
+
+    THEN("numbers below a limit cover the whole range and nothing more")
+    {
+      int counts[6] = { 0 };
+      for (int i = 0; i < 6000; ++i)
+      {
+        int const n = random.below(6);
+        REQUIRE(n >= 0);
+        REQUIRE(n < 6);
+        ++counts[n];
+      }
+      for (int count: counts)
+        REQUIRE(count > 800);
+    }
+  }
+}
@@ -0,0 +1,124 @@
+/**
+ * @file test_solver.cpp
+ * @brief Unit tests for the nodice/solver module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/solver.h"
+
+#include "nodice/threadpool.h"
+#include <vector>
+
+
+namespace
+{
+  /** Finds the best score the slow way, trying every series of moves. */
+  double
+  brute_force(NoDice::Grid const& grid, int moves_left)
+  {
+    if (moves_left == 0)
+      return 0.0;
+    NoDice::Grid::MoveList moves;
+    grid.find_winning_swaps(moves);
+    double best = 0.0;
+    for (auto const& move: moves)
+    {
+      NoDice::Grid next(grid);
+      NoDice::MoveResult result;
+      NoDice::resolve_move(next, move.first, move.second, result);
+      best = std::max(best, NoDice::PuzzleSolver::expected_score(result)
+                          + brute_force(next, moves_left - 1));
+    }
+    return best;
+  }
+
+  /** Plays out a series of moves and adds up their scores. */
+  double
+  replay(NoDice::Grid grid, NoDice::Grid::MoveList const& moves)
+  {
+    double score = 0.0;
+    for (auto const& move: moves)
+    {
+      NoDice::MoveResult result;
+      REQUIRE(NoDice::resolve_move(grid, move.first, move.second, result));
+      score += NoDice::PuzzleSolver::expected_score(result);
+    }
+    return score;
+  }
+} // anonymous namespace
+
+
+SCENARIO("solving puzzles")
+{
+  GIVEN("small puzzles with a fixed list of refills")
+  {
+    std::vector<NoDice::ShapeId> refills;
+    NoDice::Random random(5);
+    for (int i = 0; i < 200; ++i)
+      refills.push_back(NoDice::ShapeId(random.below(5)));
+
+    THEN("the solver finds the best score and a series of moves that makes it")
+    {
+      for (int seed = 0; seed < 6; ++seed)
+      {
+        NoDice::Grid grid(5, 5, seed);
+        grid.generate();
+        grid.set_refills(refills.data(), refills.size());
+
+        NoDice::PuzzleSolver solver;
+        NoDice::PuzzleSolver::Solution const solution = solver.solve(grid, 3);
+        REQUIRE(solution.score == Approx(brute_force(grid, 3)));
+        REQUIRE(solution.moves.size() <= 3);
+        REQUIRE(replay(grid, solution.moves) == Approx(solution.score));
+      }
+    }
+
+    THEN("searching in parallel finds the same moves")
+    {
+      NoDice::ThreadPool pool(3);
+      for (int seed = 0; seed < 3; ++seed)
+      {
+        NoDice::Grid grid(6, 5, seed);
+        grid.generate();
+        grid.set_refills(refills.data(), refills.size());
+
+        NoDice::PuzzleSolver serial;
+        NoDice::PuzzleSolver parallel(&pool);
+        NoDice::PuzzleSolver::Solution const s = serial.solve(grid, 3);
+        NoDice::PuzzleSolver::Solution const p = parallel.solve(grid, 3);
+        REQUIRE(p.score == s.score);
+        REQUIRE(p.moves == s.moves);
+      }
+    }
+  }
+
+  GIVEN("a puzzle whose refills run out")
+  {
+    std::vector<NoDice::ShapeId> refills = { 1, 2 };
+    NoDice::Grid grid(5, 5, 9);
+    grid.generate();
+    grid.set_refills(refills.data(), refills.size());
+
+    THEN("the holes are left empty and the search still finishes")
+    {
+      NoDice::PuzzleSolver solver;
+      NoDice::PuzzleSolver::Solution const solution = solver.solve(grid, 4);
+      REQUIRE(solution.score == Approx(brute_force(grid, 4)));
+      REQUIRE(solution.score > 0.0);
+    }
+  }
+}
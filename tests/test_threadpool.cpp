@@ -0,0 +1,59 @@
+/**
+ * @file test_threadpool.cpp
+ * @brief Unit tests for the nodice/threadpool module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/threadpool.h"
+
+#include <atomic>
+#include <vector>
+
+
+SCENARIO("running work on a thread pool")
+{
+  GIVEN("a pool of 4 threads")
+  {
+    NoDice::ThreadPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    WHEN("a parallel loop is run")
+    {
+      std::vector<int> hits(1000, 0);
+      pool.parallel_for(hits.size(), [&hits](int i) { ++hits[i]; });
+
+      THEN("every index is visited exactly once")
+      {
+        for (int h: hits)
+          REQUIRE(h == 1);
+      }
+    }
+
+    WHEN("tasks are submitted and waited for")
+    {
+      std::atomic<int> count(0);
+      for (int i = 0; i < 100; ++i)
+        pool.submit([&count] { ++count; });
+      pool.wait();
+
+      THEN("they have all run")
+      {
+        REQUIRE(count == 100);
+      }
+    }
+  }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_transposition.cpp
+ * @brief Unit tests for the nodice/transposition module.
+ *
+ * Copyright 2017 Stephen M. Webb  <stephen.webb@bregmasoft.ca>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of Version 2 of the GNU General Public License as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "catch/catch.hpp"
+#include "nodice/transposition.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+SCENARIO("caching evaluations by position hash")
+{
+  GIVEN("a small table")
+  {
+    NoDice::TranspositionTable table(100);
+    NoDice::TranspositionTable::Value value = 0;
+
+    THEN("its capacity is rounded up to a power of 2")
+    {
+      REQUIRE(table.capacity() == 128);
+    }
+
+    THEN("nothing is found in it")
+    {
+      REQUIRE_FALSE(table.find(0x1234, value));
+    }
+
+    WHEN("a value is stored")
+    {
+      table.store(0x1234, 42);
+
+      THEN("it is found under its own key")
+      {
+        REQUIRE(table.find(0x1234, value));
+        REQUIRE(value == 42);
+      }
+
+      THEN("it is not found under a key sharing its slot")
+      {
+        REQUIRE_FALSE(table.find(0x1234 + 128, value));
+      }
+
+      AND_WHEN("a key sharing its slot is stored")
+      {
+        table.store(0x1234 + 128, 7);
+
+        THEN("the new entry replaces the old one")
+        {
+          REQUIRE_FALSE(table.find(0x1234, value));
+          REQUIRE(table.find(0x1234 + 128, value));
+          REQUIRE(value == 7);
+        }
+      }
+
+      AND_WHEN("the table is cleared")
+      {
+        table.clear();
+
+        THEN("the value is gone")
+        {
+          REQUIRE_FALSE(table.find(0x1234, value));
+        }
+      }
+    }
+  }
+
+  GIVEN("a table shared by 4 threads storing over each other")
+  {
+    NoDice::TranspositionTable table(64);
+    std::atomic<int> bad_count(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+      threads.emplace_back([&table, &bad_count, t]
+      {
+        for (std::uint64_t i = 1; i < 20000; ++i)
+        {
+          std::uint64_t const key = (i * 0x9e3779b97f4a7c15ull) | 1;
+          table.store(key, key * 3 + t % 2);
+          NoDice::TranspositionTable::Value value;
+          if (table.find(key ^ 0x40, value) && value / 3 != (key ^ 0x40))
+            ++bad_count;
+        }
+      });
+    }
+    for (auto& thread: threads)
+      thread.join();
+
+    THEN("every value found belongs to the key it was found under")
+    {
+      REQUIRE(bad_count == 0);
+    }
+  }
+}